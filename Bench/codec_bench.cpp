@@ -0,0 +1,316 @@
+#include <error_repairing.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <new>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ===================================
+// allocations - counted by malloc of executable (glibc: it is found before malloc of libc by library too,
+// so results of *_c_wrapped functions are counted), other platforms - by global operator new only
+// ===================================
+
+static std::atomic<size_t> g_allocations = 0;
+
+#if defined(__GLIBC__)
+    #define BENCH_COUNTS_MALLOC 1
+
+extern "C" {
+    void* __libc_malloc  (size_t size);
+    void* __libc_calloc  (size_t amount, size_t size);
+    void* __libc_realloc (void* ptr, size_t size);
+
+    void* malloc (size_t size) noexcept {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void* calloc (size_t amount, size_t size) noexcept {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(amount, size);
+    }
+
+    void* realloc (void* ptr, size_t size) noexcept {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+}
+#else
+    #define BENCH_COUNTS_MALLOC 0
+#endif
+
+void* operator new (size_t size) {
+    if constexpr (not BENCH_COUNTS_MALLOC) g_allocations.fetch_add(1, std::memory_order_relaxed); // otherwise counted by malloc
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete (void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete (void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+// ===================================
+// measurement
+// ===================================
+
+struct Result {
+    std::string name;
+    size_t      payload_size;
+    size_t      iterations;
+    double      ns_per_packet;
+    double      mb_per_second;
+    double      allocations_per_call;
+};
+
+struct Options {
+    std::chrono::milliseconds min_time = std::chrono::milliseconds(200);
+    std::optional<std::string> output; // std::nullopt - stdout
+};
+
+/**
+ * @brief calls function in rounds until min_time is reached, function does one call of measured function
+ *        (packages - amount of packages of one call, batch functions)
+ */
+static Result measure (std::string_view name, size_t payload_size, const Options& options, const std::function<void()>& function, size_t packages = 1) {
+    using Clock = std::chrono::steady_clock;
+
+    function(); // warm up - first call allocates buffers, fills tables
+
+    size_t iterations  = 0;
+    size_t allocations = 0;
+    size_t round       = 16;
+    Clock::duration elapsed{};
+
+    while (elapsed < options.min_time) {
+        size_t allocations_before = g_allocations.load(std::memory_order_relaxed);
+        auto   start              = Clock::now();
+        for (size_t i = 0; i < round; ++i) function();
+        elapsed     += Clock::now() - start;
+        allocations += g_allocations.load(std::memory_order_relaxed) - allocations_before;
+        iterations  += round;
+
+        if (round < (size_t(1) << 20)) round *= 2;
+    }
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    iterations *= packages;
+    return Result{
+        .name                 = std::string(name),
+        .payload_size         = payload_size,
+        .iterations           = iterations,
+        .ns_per_packet        = seconds * 1e9 / double(iterations),
+        .mb_per_second        = double(payload_size) * double(iterations) / seconds / 1e6,
+        .allocations_per_call = double(allocations) * double(packages) / double(iterations),
+    };
+}
+
+// ===================================
+// reference - encode_package/decode_package of bit list (before packed codec), speedup of library is measured against it
+// ===================================
+
+static bool encode_package_list (std::vector<uint8_t>& package) {
+    uint32_t checksum = custom_utils::calculate_checksum(package);
+    for (int shift = 24; shift >= 0; shift -= 8) package.push_back(uint8_t(checksum >> shift));
+
+    std::list<bool> binary_package = custom_utils::byte_array_to_binary_list(package);
+    if (not custom_utils::encode_repair_data(binary_package)) return false;
+    package = custom_utils::binary_list_to_byte_array(binary_package);
+    return true;
+}
+
+static bool decode_package_list (std::vector<uint8_t>& package) {
+    std::list<bool> binary_package = custom_utils::byte_array_to_binary_list(package);
+    if (not custom_utils::decode_repair_data(binary_package)) return false;
+    package = custom_utils::binary_list_to_byte_array(binary_package);
+
+    if (custom_utils::calculate_checksum(package) != 0) return false;
+    package.resize(package.size() - sizeof(uint32_t));
+    return true;
+}
+
+// ===================================
+
+// payload of protocol message (or snapshot) - the content doesn't change speed of codec
+static std::vector<uint8_t> make_payload (size_t size) {
+    std::vector<uint8_t> payload(size);
+    uint32_t state = 0x12345678;
+    for (auto& byte : payload) {
+        state = state * 1664525 + 1013904223;
+        byte  = uint8_t(state >> 24);
+    }
+    return payload;
+}
+
+static void run_size (size_t size, const Options& options, std::vector<Result>& results) {
+    const std::vector<uint8_t> payload = make_payload(size);
+    std::vector<uint8_t>       encoded = payload;
+    custom_utils::encode_package(encoded);
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(encoded.size());
+    std::vector<uint8_t> result(encoded.size());
+    volatile uint32_t    sink = 0;
+
+    // library API
+    results.push_back(measure("encode_package", size, options, [&] {
+        buffer = payload;
+        custom_utils::encode_package(buffer);
+    }));
+    results.push_back(measure("decode_package", size, options, [&] {
+        buffer = encoded;
+        custom_utils::decode_package(buffer);
+    }));
+    results.push_back(measure("encode_package_into", size, options, [&] {
+        custom_utils::encode_package_into(payload, result);
+    }));
+    results.push_back(measure("decode_package_in_place", size, options, [&] {
+        std::ranges::copy(encoded, result.begin());
+        custom_utils::decode_package_in_place(result);
+    }));
+    results.push_back(measure("encode_package_list", size, options, [&] {
+        buffer = payload;
+        encode_package_list(buffer);
+    }));
+    results.push_back(measure("decode_package_list", size, options, [&] {
+        buffer = encoded;
+        decode_package_list(buffer);
+    }));
+
+    // batch of answers of one tick - compared with encode_package_into/decode_package_in_place per package
+    constexpr size_t BATCH = 32;
+    std::vector<uint8_t>                  batch_buffer(BATCH * encoded.size());
+    std::vector<std::span<const uint8_t>> batch_packages(BATCH, std::span<const uint8_t>(payload));
+    std::vector<std::span<uint8_t>>       batch_results(BATCH);
+    std::vector<std::optional<size_t>>    batch_sizes(BATCH);
+    for (size_t i = 0; i < BATCH; ++i) batch_results[i] = std::span(batch_buffer).subspan(i * encoded.size(), encoded.size());
+    results.push_back(measure("encode_packages_batch", size, options, [&] {
+        custom_utils::encode_packages_batch(batch_packages, batch_results, batch_sizes);
+    }, BATCH));
+    results.push_back(measure("decode_packages_batch", size, options, [&] {
+        for (auto& result : batch_results) std::ranges::copy(encoded, result.begin());
+        custom_utils::decode_packages_batch(batch_results, batch_sizes);
+    }, BATCH));
+
+    results.push_back(measure("calculate_checksum", size, options, [&] {
+        sink = custom_utils::calculate_checksum(payload);
+    }));
+    results.push_back(measure("calculate_checksum_slow", size, options, [&] {
+        sink = custom_utils::calculate_checksum_slow(payload);
+    }));
+
+    // C wrappers - used by python tools
+    results.push_back(measure("encode_package_c_wrapped", size, options, [&] {
+        uint8_t* c_result;
+        size_t   c_result_size;
+        buffer = payload;
+        if (c_wrapped_custom_utils::encode_package_c_wrapped(buffer.data(), buffer.size(), &c_result, &c_result_size)) {
+            c_wrapped_custom_utils::free_c_wrapped(c_result);
+        }
+    }));
+    results.push_back(measure("decode_package_c_wrapped", size, options, [&] {
+        uint8_t* c_result;
+        size_t   c_result_size;
+        buffer = encoded;
+        if (c_wrapped_custom_utils::decode_package_c_wrapped(buffer.data(), buffer.size(), &c_result, &c_result_size)) {
+            c_wrapped_custom_utils::free_c_wrapped(c_result);
+        }
+    }));
+    results.push_back(measure("encode_package_into_c_wrapped", size, options, [&] {
+        size_t c_result_size;
+        c_wrapped_custom_utils::encode_package_into_c_wrapped(payload.data(), payload.size(), result.data(), result.size(), &c_result_size);
+    }));
+    results.push_back(measure("decode_package_in_place_c_wrapped", size, options, [&] {
+        size_t c_result_size;
+        std::ranges::copy(encoded, result.begin());
+        c_wrapped_custom_utils::decode_package_in_place_c_wrapped(result.data(), result.size(), &c_result_size);
+    }));
+
+    (void)sink;
+}
+
+// ===================================
+// output
+// ===================================
+
+static std::string to_json (const std::vector<Result>& results) {
+    std::ostringstream json;
+    json << "{\n  \"benchmark\": \"late_autumn_codec_bench\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        json << "    {\"name\": \"" << result.name << "\""
+             << ", \"payload_size\": "         << result.payload_size
+             << ", \"iterations\": "           << result.iterations
+             << ", \"ns_per_packet\": "        << result.ns_per_packet
+             << ", \"mb_per_second\": "        << result.mb_per_second
+             << ", \"allocations_per_call\": " << result.allocations_per_call
+             << "}" << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+static std::optional<Options> parse_options (int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--min-time-ms" and i + 1 < argc) {
+            options.min_time = std::chrono::milliseconds(std::strtoull(argv[++i], nullptr, 10));
+        } else if (argument == "--output" and i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+int main (int argc, char** argv) {
+    std::optional<Options> options = parse_options(argc, argv);
+    if (not options.has_value()) {
+        std::cerr << "Usage: " << argv[0] << " [--min-time-ms <ms>] [--output <file.json>]\n";
+        return 1;
+    }
+
+    // LOGIN (type), MESSAGE answer (type + id), MESSAGE (type + id + data), OTHER snapshots up to 1 KiB
+    constexpr size_t SIZES[] = {1, 9, 65, 256, 1024};
+
+    std::vector<Result> results;
+    for (size_t size : SIZES) {
+        run_size(size, options.value(), results);
+    }
+
+    for (const Result& result : results) {
+        std::cerr << result.name << " (" << result.payload_size << " B): "
+                  << result.ns_per_packet << " ns, " << result.mb_per_second << " MB/s, "
+                  << result.allocations_per_call << " allocations\n";
+    }
+
+    std::string json = to_json(results);
+    if (not options->output.has_value()) {
+        std::cout << json;
+        return 0;
+    }
+
+    std::ofstream file(options->output.value());
+    if (not file) {
+        std::cerr << "Failed to open output file: " << options->output.value() << '\n';
+        return 1;
+    }
+    file << json;
+    return 0;
+}
@@ -0,0 +1,317 @@
+#include <Socket.h>
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Receive and send paths of server socket on loopback:
+ *     blocking    - blocking socket, recvfrom/sendto for every datagram (server before event loop)
+ *     epoll       - Udp_socket, wait by epoll, recvfrom/sendto for every datagram (--io-batch 1)
+ *     epoll_batch - Udp_socket, recvmmsg/sendmmsg (--io-batch 32)
+ *     io_uring    - Udp_socket, multishot receive into provided buffers, sends submitted together
+ */
+
+// ===================================
+// measurement
+// ===================================
+
+struct Result {
+    std::string name;
+    size_t      datagrams;
+    double      ns_per_datagram;
+    double      datagrams_per_second;
+    double      syscalls_per_datagram;
+};
+
+struct Options {
+    size_t datagrams = 200000;
+    uint16_t port    = 20200;
+    std::optional<std::string> output; // std::nullopt - stdout
+};
+
+constexpr size_t DATAGRAM_SIZE = 65;  // MESSAGE package after encoding
+constexpr size_t BATCH         = 32;
+constexpr size_t WINDOW        = 64;  // datagrams sent and not received yet - they fit default receive buffer of socket
+constexpr size_t TICK          = 256; // answers of one tick (send)
+
+using Clock = std::chrono::steady_clock;
+
+static Socket_address loopback (uint16_t port) {
+    return Socket_address{.ip=htonl(INADDR_LOOPBACK), .port=port};
+}
+
+static int open_blocking_socket (std::optional<uint16_t> port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1) return -1;
+
+    // timeout - receiver sees end of measurement
+    timeval timeout{.tv_sec=0, .tv_usec=100000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (not port.has_value()) return fd;
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(port.value());
+    if (bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * @brief sender thread keeps WINDOW datagrams in flight, receive_all receives until all are received (or timeout)
+ *        and returns amount of its syscalls
+ */
+template <class Receive_all>
+static std::optional<Result> measure_receive (std::string_view name, const Options& options, std::atomic<size_t>& received, Receive_all&& receive_all) {
+    int sender = open_blocking_socket(std::nullopt);
+    if (sender == -1) return std::nullopt;
+
+    std::vector<uint8_t> datagram(DATAGRAM_SIZE, 0xA5);
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port        = htons(options.port);
+
+    std::atomic<bool> is_receiving = true; // receiver can stop earlier when datagrams are lost
+    auto start = Clock::now();
+    std::thread sender_thread([&] {
+        for (size_t sent = 0; sent < options.datagrams and is_receiving; ++sent) {
+            while (sent - received.load(std::memory_order_acquire) >= WINDOW and is_receiving) std::this_thread::yield();
+            sendto(sender, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        }
+    });
+    uint64_t syscalls = receive_all();
+    auto elapsed = Clock::now() - start;
+    is_receiving = false;
+    sender_thread.join();
+    ::close(sender);
+
+    size_t amount = received.load();
+    if (amount < options.datagrams) {
+        std::cerr << name << ": " << options.datagrams - amount << " datagrams were lost\n";
+    }
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return Result{
+        .name                  = std::string(name),
+        .datagrams             = amount,
+        .ns_per_datagram       = seconds * 1e9 / double(amount),
+        .datagrams_per_second  = double(amount) / seconds,
+        .syscalls_per_datagram = double(syscalls) / double(amount),
+    };
+}
+
+static std::optional<Result> receive_blocking (const Options& options) {
+    int fd = open_blocking_socket(options.port);
+    if (fd == -1) return std::nullopt;
+
+    std::atomic<size_t> received = 0;
+    std::optional<Result> result = measure_receive("receive/blocking", options, received, [&] {
+        std::vector<uint8_t> buffer(1024);
+        uint64_t syscalls = 0;
+        while (received.load() < options.datagrams) {
+            sockaddr_in from;
+            socklen_t   from_size = sizeof(from);
+            ++syscalls;
+            if (recvfrom(fd, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&from), &from_size) < 0) break; // timeout - lost
+            received.fetch_add(1, std::memory_order_release);
+        }
+        return syscalls;
+    });
+    ::close(fd);
+    return result;
+}
+
+static std::optional<Result> receive_socket (std::string_view name, const Options& options, Socket_backend backend, size_t batch) {
+    Udp_socket socket;
+    if (not socket.open(options.port, false, backend)) return std::nullopt;
+    if (socket.backend() != backend) return std::nullopt;
+
+    std::atomic<size_t> received = 0;
+    return measure_receive(name, options, received, [&] {
+        std::vector<uint8_t>           buffers(batch * 1024);
+        std::vector<Received_datagram> datagrams(batch);
+        while (received.load() < options.datagrams) {
+            if (not socket.wait(std::chrono::milliseconds(100))) break; // timeout - lost
+
+            while (true) {
+                // caller's buffers - io_uring replaces them by its own
+                for (size_t i = 0; i < batch; ++i) datagrams[i].buffer = std::span(buffers).subspan(i * 1024, 1024);
+
+                Socket_error error;
+                size_t amount = (batch == 1)
+                    ? (socket.receive(datagrams[0].buffer, datagrams[0].from, error).has_value() ? 1 : 0)
+                    : socket.receive_batch(datagrams, error);
+                if (amount == 0) break;
+                received.fetch_add(amount, std::memory_order_release);
+                if (batch != 1 and amount < batch) break;
+            }
+        }
+        Socket_statistics statistics = socket.statistics();
+        return statistics.wait_calls + statistics.receive_calls;
+    });
+}
+
+/**
+ * @brief sends datagrams in ticks of TICK datagrams to socket nobody reads (loopback drops them when it is full)
+ */
+static std::optional<Result> send_socket (std::string_view name, const Options& options, std::optional<Socket_backend> backend, size_t batch) {
+    int sink = open_blocking_socket(uint16_t(options.port + 1));
+    if (sink == -1) return std::nullopt;
+
+    std::vector<uint8_t>       datagram(DATAGRAM_SIZE, 0x5A);
+    std::vector<Sent_datagram> tick(TICK, Sent_datagram{.data=datagram, .to=loopback(uint16_t(options.port + 1))});
+    uint64_t syscalls = 0;
+    Clock::duration elapsed{};
+
+    if (not backend.has_value()) { // blocking sendto
+        int fd = open_blocking_socket(std::nullopt);
+        sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family      = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port        = htons(uint16_t(options.port + 1));
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < options.datagrams; ++i) {
+            sendto(fd, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        }
+        elapsed  = Clock::now() - start;
+        syscalls = options.datagrams;
+        ::close(fd);
+    } else {
+        Udp_socket socket;
+        if (not socket.open(options.port, false, backend.value()) or socket.backend() != backend.value()) {
+            ::close(sink);
+            return std::nullopt;
+        }
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < options.datagrams; i += TICK) {
+            std::span<const Sent_datagram> datagrams = std::span(tick).first(std::min(TICK, options.datagrams - i));
+            if (batch == 1) {
+                for (const Sent_datagram& sent : datagrams) socket.send(sent.data, sent.to);
+                continue;
+            }
+            for (size_t j = 0; j < datagrams.size(); j += batch) {
+                socket.send_batch(datagrams.subspan(j, std::min(batch, datagrams.size() - j)));
+            }
+        }
+        elapsed  = Clock::now() - start;
+        syscalls = socket.statistics().send_calls;
+    }
+    ::close(sink);
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return Result{
+        .name                  = std::string(name),
+        .datagrams             = options.datagrams,
+        .ns_per_datagram       = seconds * 1e9 / double(options.datagrams),
+        .datagrams_per_second  = double(options.datagrams) / seconds,
+        .syscalls_per_datagram = double(syscalls) / double(options.datagrams),
+    };
+}
+
+// ===================================
+// output
+// ===================================
+
+static std::string to_json (const std::vector<Result>& results) {
+    std::ostringstream json;
+    json << "{\n  \"benchmark\": \"late_autumn_socket_bench\",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        json << "    {\"name\": \"" << result.name << "\""
+             << ", \"datagrams\": "             << result.datagrams
+             << ", \"ns_per_datagram\": "       << result.ns_per_datagram
+             << ", \"datagrams_per_second\": "  << result.datagrams_per_second
+             << ", \"syscalls_per_datagram\": " << result.syscalls_per_datagram
+             << "}" << (i + 1 == results.size() ? "\n" : ",\n");
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+static std::optional<Options> parse_options (int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--datagrams" and i + 1 < argc) {
+            options.datagrams = std::max<size_t>(std::strtoull(argv[++i], nullptr, 10), 1);
+        } else if (argument == "--port" and i + 1 < argc) {
+            options.port = uint16_t(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--output" and i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            return std::nullopt;
+        }
+    }
+    return options;
+}
+
+int main (int argc, char** argv) {
+    std::optional<Options> options = parse_options(argc, argv);
+    if (not options.has_value()) {
+        std::cerr << "Usage: " << argv[0] << " [--datagrams <n>] [--port <port>] [--output <file.json>]\n";
+        return 1;
+    }
+
+    bool has_io_uring = Udp_socket::supports_io_uring();
+    if (not has_io_uring) std::cerr << "io_uring is unavailable - its results are skipped\n";
+
+    std::vector<std::optional<Result>> measured;
+    measured.push_back(receive_blocking(options.value()));
+    measured.push_back(receive_socket("receive/epoll",       options.value(), Socket_backend::EPOLL, 1));
+    measured.push_back(receive_socket("receive/epoll_batch", options.value(), Socket_backend::EPOLL, BATCH));
+    if (has_io_uring) measured.push_back(receive_socket("receive/io_uring", options.value(), Socket_backend::IO_URING, BATCH));
+
+    measured.push_back(send_socket("send/blocking",    options.value(), std::nullopt,          1));
+    measured.push_back(send_socket("send/epoll",       options.value(), Socket_backend::EPOLL, 1));
+    measured.push_back(send_socket("send/epoll_batch", options.value(), Socket_backend::EPOLL, BATCH));
+    if (has_io_uring) measured.push_back(send_socket("send/io_uring", options.value(), Socket_backend::IO_URING, TICK));
+
+    std::vector<Result> results;
+    for (const std::optional<Result>& result : measured) {
+        if (result.has_value()) results.push_back(result.value());
+    }
+
+    for (const Result& result : results) {
+        std::cerr << result.name << ": " << result.ns_per_datagram << " ns, " << result.datagrams_per_second << " datagrams/s, "
+                  << result.syscalls_per_datagram << " syscalls per datagram\n";
+    }
+
+    std::string json = to_json(results);
+    if (not options->output.has_value()) {
+        std::cout << json;
+        return 0;
+    }
+
+    std::ofstream file(options->output.value());
+    if (not file) {
+        std::cerr << "Failed to open output file: " << options->output.value() << '\n';
+        return 1;
+    }
+    file << json;
+    return 0;
+}
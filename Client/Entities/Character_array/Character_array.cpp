@@ -12,9 +12,7 @@
 
 Character_array::Character_array (Player& player, Network& network, RenderWindow& window, const Map& map)
     : m_player{player}, m_network{network},  m_window{window}, m_map{map},
-      m_characters{},   m_other_requests{},  m_requests{} {
-        m_characters.reserve(10);
-}
+      m_characters{} {}
 
 Character_array::~Character_array  () {
     std::optional<bool> disconected = m_network.send_disconnection();
@@ -65,7 +63,7 @@ void Character_array::update () {
 
     m_player.make_tick(run_time);
     m_player.make_logical_tick(run_time);
-    for (auto& character : m_characters) {
+    for (auto& [id, character] : m_characters) {
         character.make_tick(run_time);
         character.make_logical_tick(run_time);
     }
@@ -82,19 +80,13 @@ void Character_array::draw () {
     int bottom_most_y = camera.y + camera.h + RENDER_OFFSET;
 
     m_window.draw_entity(&m_player, {camera.x, camera.y});
-    // std::cout << "amount of nya: " << m_amount_of_opponents << '\n';
-    for (size_t i = 0; i < m_amount_of_opponents; ++i) {
-        Opponent& character = m_characters[i];
+
+    std::lock_guard<std::mutex> lock(m_update_mutex); // opponents are replaced by receive thread
+    for (auto& [id, character] : m_characters) {
+        // server sends mostly players near camera - far ones come with rare snapshots of all players
         bool is_x_ok = character.get_position().x >= left_most_x and character.get_position().x <= right_most_x;
-        if (not is_x_ok) {
-            std::osyncstream(std::cout) << "character: " << i << " is out of camera view (x)" << '\n';
-            continue;
-        }
         bool is_y_ok = character.get_position().y >= top_most_y  and character.get_position().y <= bottom_most_y;
-        if (not is_y_ok) {
-            std::osyncstream(std::cout) << "character: " << i << " is out of camera view (y)" << '\n';
-            continue;
-        }
+        if (not is_x_ok or not is_y_ok) continue;
         m_window.draw_entity(&character, {camera.x, camera.y});
     }
 }
@@ -135,35 +127,6 @@ void Character_array::handle_keyboard_input () {
 }
 
 
-// ========================================================
-// network functions - update buffer
-// ========================================================
-
-void Character_array::update_opponents_amount () {
-    if (m_characters.size() > m_amount_of_opponents) return; // TODO: maybe add algo for removing opponents
-
-    for (size_t i = 0; i < m_amount_of_opponents - m_characters.size(); ++i) {
-        SDL_Texture* oponent_texture = m_window.load_texture(Opponent::INFO.texture_path); // TODO: maybe add algo for removing opponents (could influence this line - or its results)
-        m_characters.emplace_back(Opponent{oponent_texture, m_map.get_player_start_position(), m_map});
-    }
-}
-
-
-void Character_array::update_get_other_requests (id_game_t processed_id) {
-    if (m_other_requests.empty()) return;
-
-    for (auto it = m_other_requests.begin(); it != m_other_requests.end();) {
-        if (*it <= processed_id) {
-            m_requests.erase(*it);
-            it = m_other_requests.erase(it);
-        } else {
-            ++it;
-        }
-    }
-}
-
-
-
 // ========================================================
 // network functions
 // ========================================================
@@ -171,7 +134,9 @@ void Character_array::update_get_other_requests (id_game_t processed_id) {
 void Character_array::send_thread() {
     while (m_is_network_thread_running.load()) {
         send_current_position();
-        m_network.send_ask_other();
+        if (not m_network.is_pushed()) m_network.send_ask_other(); // otherwise opponents are pushed by server after its ticks
+        m_network.send_snapshot_acknowledge();
+        m_network.send_fec_flush(); // last messages aren't left without parity
         std::this_thread::sleep_for(std::chrono::milliseconds(SEND_TIME_MS));
     }
 }
@@ -210,33 +175,25 @@ void Character_array::process_answer (Answer& answer) {
 }
 
 void Character_array::update_opponents (Answer& answer) {
-    std::lock_guard<std::mutex> lock(m_update_mutex); // check for ownership
-
-    m_amount_of_opponents = answer.other->size();
-    update_opponents_amount();
-
     if (not answer.other.has_value()) {
         std::cerr << "Inconsistent network answer - no other players\n";
         return;
     }
 
-    // update data
+    std::lock_guard<std::mutex> lock(m_update_mutex); // check for ownership
 
-    std::vector<Answer::Other>& other = answer.other.value();
-    for (size_t i = 0; i < m_amount_of_opponents; ++i) {
-        Answer::Other_Payload& info = other[i].payload;
-        // m_characters[i].update_position({static_cast<float>(info.x), static_cast<float>(info.y)});
-        // m_characters[i].update_speed({static_cast<float>(info.dx), static_cast<float>(info.dy)});
-        // m_characters[i].update_velocity({static_cast<float>(info.ddx), static_cast<float>(info.ddy)});
-        m_characters[i].set_next_state(info);
-    }
+    if (m_opponent_texture == nullptr) m_opponent_texture = m_window.load_texture(Opponent::INFO.texture_path);
 
-    // update buffer
-    if (not answer.id.has_value()) {
-        std::cerr << "Inconsistent network answer - no id\n";
-        return;
+    // opponent of every player is found by its id (order of answer changes) - opponents of players missing in answer are gone
+    std::map<id_game_t, Opponent> characters;
+    for (const Answer::Other& other : answer.other.value()) {
+        auto node = m_characters.extract(other.id);
+        auto character = node.empty()
+            ? characters.try_emplace(other.id, m_opponent_texture, m_map.get_player_start_position(), m_map).first
+            : characters.insert(std::move(node)).position;
+        character->second.set_next_state(other.payload);
     }
-    update_get_other_requests(answer.id.value());
+    m_characters = std::move(characters);
 }
 
 void Character_array::update_player (Answer& answer) {
@@ -244,7 +201,6 @@ void Character_array::update_player (Answer& answer) {
         std::cerr << "Inconsistent network answer - no id\n";
         return;
     }
-    m_requests.erase(answer.id.value());
 }
 
 void Character_array::finish_process_response (Answer& answer) {
@@ -8,6 +8,7 @@
 #include "Map.h"
 #include "RenderWindow.h"
 #include <list>
+#include <map>
 #include <thread>
 
 /**
@@ -53,20 +54,13 @@ class Character_array {
         // network additional endpoints (beside network's ones)
         void send_current_position   ();
 
-        // update buffer
-        void update_opponents_amount   ();
-        void update_get_other_requests (id_game_t processed_id);
-
     private:
         Player&               m_player;
         Network&              m_network;
         RenderWindow&         m_window;
         const Map&            m_map;
-        std::vector<Opponent> m_characters; // id doesn't matter here so we can use n amount of opponents while n >= amount of opponents on server (and then just increase if needed)
-        size_t                m_amount_of_opponents = 0;
-
-        std::list<id_game_t>         m_other_requests;
-        std::map<id_game_t, Package> m_requests;
+        std::map<id_game_t, Opponent> m_characters;                // key - id of player on server, players missing in answer are gone
+        SDL_Texture*                  m_opponent_texture = nullptr; // shared by opponents, loaded with first one
 
         std::mutex         m_update_mutex;
         std::atomic<bool>  m_is_network_thread_running = false;
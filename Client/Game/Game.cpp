@@ -5,6 +5,7 @@
 #include "SDL3/SDL_timer.h"
 #include "SDL3_ttf/SDL_ttf.h"
 #include "Text.h"
+#include <algorithm>
 #include <iostream>
 
 
@@ -130,6 +131,11 @@ void Game::connect_to_server () {
 
     // -----------------
 
+    // compact state - positions are quantized over bounds of map
+    m_network.set_compact(custom_utils::Compact_config{
+        .map_width =static_cast<uint16_t>(std::min<size_t>(m_map.get_width(),  UINT16_MAX)),
+        .map_height=static_cast<uint16_t>(std::min<size_t>(m_map.get_height(), UINT16_MAX)),
+    });
     m_network.send_connection();
     std::optional<Answer> answer = m_network.get_answer();
 
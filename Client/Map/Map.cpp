@@ -155,6 +155,8 @@ const SDL_FPoint& Map::get_player_start_position () const {
     // return m_player_start;
 }
 const SDL_FPoint& Map::get_finish_position       () const { return m_finish; }
+size_t            Map::get_width                 () const { return m_i_len;  }
+size_t            Map::get_height                () const { return m_j_len;  }
 
 void Map::set (size_t i, size_t j, Map::MAP_LEGEND value) {
     if (i >= m_i_len or j >= m_j_len or j * m_i_len + i >= m_map.size()) {
@@ -37,6 +37,8 @@ public:
 
     [[nodiscard]] const SDL_FPoint& get_player_start_position () const;
     [[nodiscard]] const SDL_FPoint& get_finish_position       () const;
+    [[nodiscard]] size_t            get_width                 () const; // tiles
+    [[nodiscard]] size_t            get_height                () const; // tiles
 
 private:
     std::vector<char> m_map; // char is ok for 1-4, maybe even redundant
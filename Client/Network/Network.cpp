@@ -1,4 +1,7 @@
 #include "Network.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <syncstream>
@@ -27,6 +30,15 @@ Network::~Network () {
 }
 
 bool Network::is_connected () const { return m_is_connected_to_server; }
+bool Network::is_pushed    () const { return m_is_pushed; }
+
+void Network::set_fec (std::optional<custom_utils::Fec_config> config) {
+    m_fec_config = config;
+}
+
+void Network::set_compact (std::optional<custom_utils::Compact_config> config) {
+    m_compact_config = config;
+}
 
 bool Network::setup_socket () {
     if (m_is_socket_setuped) return true;
@@ -99,7 +111,7 @@ bool Network::decode_message (std::vector<uint8_t>& message) {
     return custom_utils::decode_package(message);
 }
 
-std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message) {
+std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message, const std::optional<custom_utils::Compact_config>& compact) {
     // Ensure that the message size is exactly what we expect
     if (message.size() == 0) {
         return std::nullopt;
@@ -117,7 +129,7 @@ std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message
 
     // 1. Type (1 byte)
     answer.type = static_cast<Answer::Type>(data[0]);
-    if (int(answer.type) < int(Answer::Type::BAD_FORMED) || int(answer.type) > int(Answer::Type::BREAK_SESSION)) {
+    if (int(answer.type) < int(Answer::Type::BAD_FORMED) || int(answer.type) > int(Answer::Type::OTHER_DELTA_COMPACT)) {
         return Answer{.type=Answer::Type::BAD_FORMED};
     }
     data_disposition += sizeof(uint8_t);
@@ -173,8 +185,9 @@ std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message
             size_t count = *reinterpret_cast<size_t*>(&count_net);
             data_disposition += sizeof(uint64_t);
 
-            // sizeof(Answer::Other) = sizeof(uint64_t) + 6 * sizeof(double)
-            if (message.size() != data_disposition + count * sizeof(Answer::Other)) { // enough data for count
+            // id, x/y/dx/dy/ddx/ddy, time
+            constexpr size_t OTHER_SIZE = sizeof(uint64_t) + 6 * sizeof(double) + sizeof(uint64_t);
+            if (message.size() != data_disposition + count * OTHER_SIZE) { // enough data for count
                 return Answer{.type=Answer::Type::BAD_FORMED};
             }
 
@@ -222,6 +235,74 @@ std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message
             answer.other = others;
             break;
         }
+        case Answer::Type::OTHER_DELTA: {
+            // 3.1 Delta (id: 8 bytes, baseline: 8 bytes, count: 8 bytes, then [id: 8 bytes, mask: 1 byte, field of every bit: 8 bytes])
+            if (message.size() < data_disposition + 3 * sizeof(uint64_t)) { // has id, baseline and count
+                return Answer{.type=Answer::Type::BAD_FORMED};
+            }
+
+            memcpy(&llong_value, data + data_disposition, sizeof(llong_value));
+            answer.id = ntohll(llong_value);
+            data_disposition += sizeof(uint64_t);
+
+            memcpy(&llong_value, data + data_disposition, sizeof(llong_value));
+            answer.baseline = ntohll(llong_value);
+            data_disposition += sizeof(uint64_t);
+
+            memcpy(&llong_value, data + data_disposition, sizeof(llong_value));
+            uint64_t count = ntohll(llong_value);
+            data_disposition += sizeof(uint64_t);
+
+            // every entry has at least id and mask
+            if ((message.size() - data_disposition) / (sizeof(uint64_t) + sizeof(uint8_t)) < count) {
+                return Answer{.type=Answer::Type::BAD_FORMED};
+            }
+
+            std::vector<Answer::Other> others;
+            others.reserve(count);
+
+            for (uint64_t i = 0; i < count; ++i) {
+                Answer::Other other{};
+
+                if (message.size() < data_disposition + sizeof(uint64_t) + sizeof(uint8_t)) {
+                    return Answer{.type=Answer::Type::BAD_FORMED};
+                }
+                memcpy(&llong_value, data + data_disposition, sizeof(uint64_t));
+                other.id = ntohll(llong_value);
+                data_disposition += sizeof(uint64_t);
+
+                other.changed = data[data_disposition];
+                data_disposition += sizeof(uint8_t);
+                if (other.changed & ~Answer::ALL_FIELDS) {
+                    return Answer{.type=Answer::Type::BAD_FORMED};
+                }
+
+                if (message.size() < data_disposition + std::popcount(other.changed) * sizeof(uint64_t)) {
+                    return Answer{.type=Answer::Type::BAD_FORMED};
+                }
+                double* fields[] = {&other.payload.x, &other.payload.y, &other.payload.dx, &other.payload.dy, &other.payload.ddx, &other.payload.ddy};
+                for (size_t field = 0; field < std::size(fields); ++field) {
+                    if (not (other.changed & (1u << field))) continue;
+                    memcpy(&llong_value, data + data_disposition, sizeof(uint64_t));
+                    *fields[field] = network_to_host_double(llong_value);
+                    data_disposition += sizeof(uint64_t);
+                }
+                if (other.changed & (1u << std::size(fields))) {
+                    memcpy(&llong_value, data + data_disposition, sizeof(uint64_t));
+                    other.payload.time = ntohll(llong_value);
+                    data_disposition += sizeof(uint64_t);
+                }
+
+                others.push_back(other);
+            }
+
+            if (message.size() != data_disposition) {
+                return Answer{.type=Answer::Type::BAD_FORMED};
+            }
+
+            answer.other = others;
+            break;
+        }
         case Answer::Type::ACKNOWLEDGE: {
             // 4. ID (8 bytes)
             if (message.size() != data_disposition + sizeof(uint64_t)) {
@@ -232,7 +313,21 @@ std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message
 
             break;
         }
+        case Answer::Type::OTHER_COMPACT:
+        case Answer::Type::OTHER_DELTA_COMPACT: {
+            // 3.2 Compact (id, [baseline], count - varints, then [id - varint, [mask: 1 byte], quantized state of mask])
+            if (not compact.has_value() or not parse_compact_other(message, data_disposition, compact.value(), answer)) {
+                return Answer{.type=Answer::Type::BAD_FORMED};
+            }
+            break;
+        }
         case Answer::Type::REGISTERED_ANSWER: {
+            // 5. Flags of session (optional: 1 byte) - 1: compact state is accepted, 2: snapshots are pushed
+            if (message.size() == data_disposition + sizeof(uint8_t)) {
+                answer.is_compact = static_cast<bool>(data[data_disposition] & 1);
+                answer.is_pushing = static_cast<bool>(data[data_disposition] & 2);
+                data_disposition += sizeof(uint8_t);
+            }
             if (message.size() != data_disposition) {
                 return Answer{.type=Answer::Type::BAD_FORMED};
             }
@@ -244,6 +339,52 @@ std::optional<Answer> Network::parse_answer (const std::vector<uint8_t>& message
     return answer;
 }
 
+bool Network::parse_compact_other (std::span<const uint8_t> message, size_t data_disposition, const custom_utils::Compact_config& compact, Answer& answer) {
+    bool is_delta = answer.type == Answer::Type::OTHER_DELTA_COMPACT;
+    answer.type   = is_delta ? Answer::Type::OTHER_DELTA : Answer::Type::OTHER;
+
+    std::optional<uint64_t> id = custom_utils::read_varint(message, data_disposition);
+    if (not id.has_value()) return false;
+    answer.id = id.value();
+
+    if (is_delta) {
+        std::optional<uint64_t> baseline = custom_utils::read_varint(message, data_disposition);
+        if (not baseline.has_value()) return false;
+        answer.baseline = baseline.value();
+    }
+
+    std::optional<uint64_t> count = custom_utils::read_varint(message, data_disposition);
+    if (not count.has_value() or count.value() > message.size() - data_disposition) return false; // every entry has at least one byte
+
+    std::vector<Answer::Other> others;
+    others.reserve(count.value());
+    for (uint64_t i = 0; i < count.value(); ++i) {
+        Answer::Other other{};
+
+        std::optional<uint64_t> other_id = custom_utils::read_varint(message, data_disposition);
+        if (not other_id.has_value()) return false;
+        other.id = other_id.value();
+
+        if (is_delta) {
+            if (data_disposition >= message.size()) return false;
+            other.changed = message[data_disposition];
+            data_disposition += sizeof(uint8_t);
+            if (other.changed & ~custom_utils::COMPACT_ALL_FIELDS) return false;
+        }
+
+        // fields outside of mask are ignored by apply_delta
+        custom_utils::Compact_state state = custom_utils::quantize_state(compact, other.payload);
+        if (not custom_utils::read_compact_state(message, data_disposition, other.changed, state)) return false;
+        custom_utils::dequantize_state(compact, state, other.payload);
+
+        others.push_back(other);
+    }
+    if (data_disposition != message.size()) return false;
+
+    answer.other = others;
+    return true;
+}
+
 // ========================================================
 // send data
 // ========================================================
@@ -257,6 +398,13 @@ void Network::serialize_package (const Package& package, std::vector<uint8_t>& b
     uint8_t type = *reinterpret_cast<const uint8_t*>(&package.type);
     buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&type), reinterpret_cast<uint8_t*>(&type) + sizeof(type));
 
+    // compact message - varint id and quantized state
+    if (package.compact_state.has_value()) {
+        custom_utils::write_varint(package.id.value_or(0), buffer);
+        custom_utils::write_compact_state(package.compact_state.value(), custom_utils::COMPACT_ALL_FIELDS, buffer);
+        return;
+    }
+
     // due to how type works - in current implementation, only one payload can be in the answer
     if (package.id.has_value()) {
         uint64_t id = ntohll(package.id.value());
@@ -280,9 +428,19 @@ void Network::serialize_package (const Package& package, std::vector<uint8_t>& b
         d_value = ntohll(*reinterpret_cast<const unsigned long long*>(&package.payload.value().ddy));
         buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&d_value), reinterpret_cast<uint8_t*>(&d_value) + sizeof(d_value));
 
-        uint64_t time = package.payload.value().time;
+        uint64_t time = ntohll(package.payload.value().time); // network byte order, like the doubles
         buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&time), reinterpret_cast<uint8_t*>(&time) + sizeof(time));
     }
+
+    if (package.fec.has_value()) {
+        buffer.push_back(static_cast<uint8_t>(package.fec->scheme));
+        buffer.push_back(package.fec->data_shards);
+        buffer.push_back(package.fec->parity_shards);
+    }
+
+    if (package.compact.has_value()) {
+        custom_utils::write_compact_config(package.compact.value(), buffer);
+    }
 }
 
 bool Network::send_package (const Package& package) {
@@ -295,6 +453,11 @@ bool Network::send_package (const Package& package) {
     // prepare data
     std::vector<uint8_t> buffer;
     serialize_package(package, buffer);
+
+    return send_buffer(buffer);
+}
+
+bool Network::send_buffer (std::vector<uint8_t>& buffer) {
     if (not encode_message(buffer)) {
         std::osyncstream(std::cerr) << "Failed to encode message - inner error\n";
         exit(1);
@@ -321,6 +484,13 @@ std::optional<Answer> Network::get_answer () {
         exit(1);
     }
 
+    // answer restored by fec earlier
+    if (not m_restored_messages.empty()) {
+        std::vector<uint8_t> data = std::move(m_restored_messages.front());
+        m_restored_messages.pop_front();
+        return read_answer(data);
+    }
+
     // get data cycle
     int server_address_size = sizeof(*m_server_address->ai_addr);
     static std::array<char, 1024> buffer;
@@ -337,20 +507,91 @@ std::optional<Answer> Network::get_answer () {
     // process data
     std::vector<uint8_t> data(buffer.data(), buffer.data() + static_cast<size_t>(data_size));
     decode_message(data);
-    std::optional<Answer> answer = parse_answer(data);
+
+    // fec datagram - answer can be restored later
+    if (not data.empty() and data[0] == custom_utils::FEC_PACKAGE_TYPE) {
+        std::vector<std::vector<uint8_t>> answers = m_fec_decoder.push(data);
+        if (answers.empty()) return std::nullopt;
+
+        for (size_t i = 1; i < answers.size(); ++i) m_restored_messages.push_back(std::move(answers[i]));
+        data = std::move(answers[0]);
+    }
+
+    return read_answer(data);
+}
+
+std::optional<Answer> Network::read_answer (const std::vector<uint8_t>& message) {
+    std::optional<Answer> answer = parse_answer(message, m_is_compact ? m_compact_config : std::nullopt);
 
     if (not answer.has_value()) return answer; // error - return
 
     // check if connected (registered) or disconnected (break session)
     if (answer->type == Answer::Type::REGISTERED_ANSWER) {
         m_is_connected_to_server = true;
+        m_is_compact             = answer->is_compact and m_compact_config.has_value();
+        m_is_pushed              = answer->is_pushing;
     } else if (answer->type == Answer::Type::BREAK_SESSION) {
         m_is_connected_to_server = false;
     }
 
+    // pushed snapshot - delta is returned as whole snapshot
+    if (answer->type == Answer::Type::OTHER_DELTA) {
+        answer = apply_delta(answer.value());
+        if (not answer.has_value()) return answer;
+    }
+    // only pushed snapshots are baselines - id of answer to GET_OTHER is id of request
+    if (m_is_pushed and answer->type == Answer::Type::OTHER) store_snapshot(answer.value());
+
     return answer;
 }
 
+std::optional<Answer> Network::apply_delta (const Answer& delta) {
+    auto baseline = std::find_if(m_snapshots.begin(), m_snapshots.end(), [&](const auto& snapshot) { return snapshot.first == delta.baseline; });
+    if (baseline == m_snapshots.end()) {
+        // server sends whole snapshot after acknowledge of nothing
+        m_last_snapshot = 0;
+        return std::nullopt;
+    }
+
+    Answer answer {.type=Answer::Type::OTHER, .id=delta.id, .other=baseline->second};
+    std::vector<Answer::Other>& others = answer.other.value();
+    for (const Answer::Other& changed : delta.other.value()) {
+        auto other = std::find_if(others.begin(), others.end(), [&](const Answer::Other& other) { return other.id == changed.id; });
+
+        if (changed.changed == 0) { // player left
+            if (other != others.end()) others.erase(other);
+            continue;
+        }
+        if (other == others.end()) { // new player - all fields are sent
+            if (changed.changed != Answer::ALL_FIELDS) {
+                m_last_snapshot = 0;
+                return std::nullopt;
+            }
+            others.push_back(Answer::Other{.payload=changed.payload, .id=changed.id});
+            continue;
+        }
+
+        Answer::Other_Payload& payload = other->payload;
+        if (changed.changed & (1u << 0)) payload.x    = changed.payload.x;
+        if (changed.changed & (1u << 1)) payload.y    = changed.payload.y;
+        if (changed.changed & (1u << 2)) payload.dx   = changed.payload.dx;
+        if (changed.changed & (1u << 3)) payload.dy   = changed.payload.dy;
+        if (changed.changed & (1u << 4)) payload.ddx  = changed.payload.ddx;
+        if (changed.changed & (1u << 5)) payload.ddy  = changed.payload.ddy;
+        if (changed.changed & (1u << 6)) payload.time = changed.payload.time;
+    }
+
+    return answer;
+}
+
+void Network::store_snapshot (const Answer& answer) {
+    if (not answer.id.has_value() or not answer.other.has_value()) return;
+
+    m_snapshots.emplace_back(answer.id.value(), answer.other.value());
+    if (m_snapshots.size() > SNAPSHOT_HISTORY) m_snapshots.pop_front();
+    m_last_snapshot = answer.id.value();
+}
+
 // ========================================================
 // data senders
 // ========================================================
@@ -358,8 +599,18 @@ std::optional<Answer> Network::get_answer () {
 std::optional<bool> Network::send_connection () {
     if (m_is_connected_to_server) return std::nullopt;
 
+    // times of compact session are relative to its start
+    if (m_compact_config.has_value()) {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        m_compact_config->session_start = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+    }
+
     // make data for connection
-    Package data {.type=Package::Type::LOGIN};
+    Package data {.type=Package::Type::LOGIN, .fec=m_fec_config, .compact=m_compact_config};
+
+    // new session - groups start from the beginning
+    m_fec_encoder.reset();
+    if (m_fec_config.has_value()) m_fec_encoder.emplace(m_fec_config.value());
 
     // send
     return send_package(data);
@@ -395,8 +646,27 @@ std::optional<id_game_t> Network::send_message (const Package::Package_Payload&
     Package data {.type=Package::Type::MESSAGE, .id=m_next_package_id, .payload=payload};
     ++m_next_package_id;
 
+    // compact session - quantized state instead of doubles
+    if (m_is_compact) {
+        data.type          = Package::Type::COMPACT_MESSAGE;
+        data.compact_state = custom_utils::quantize_state(m_compact_config.value(), payload);
+    }
+
     // send
-    if (not send_package(data)) return std::nullopt;
+    if (not m_fec_encoder.has_value()) {
+        if (not send_package(data)) return std::nullopt;
+        return m_next_package_id - 1;
+    }
+
+    // fec session - data datagram now, parity datagrams after last message of group (or by send_fec_flush)
+    std::vector<uint8_t> buffer;
+    serialize_package(data, buffer);
+    std::optional<std::vector<std::vector<uint8_t>>> datagrams = m_fec_encoder->push(buffer);
+    if (not datagrams.has_value()) return std::nullopt;
+
+    for (auto& datagram : datagrams.value()) {
+        if (not send_buffer(datagram)) return std::nullopt;
+    }
 
     return m_next_package_id - 1;
 }
@@ -414,6 +684,32 @@ std::optional<id_game_t> Network::send_finish (const Package::Package_Payload& p
 }
 
 
+std::optional<id_game_t> Network::send_snapshot_acknowledge () {
+    if (not m_is_connected_to_server) return std::nullopt;
+
+    id_game_t snapshot = m_last_snapshot;
+    if (snapshot == m_acknowledged_snapshot) return std::nullopt;
+
+    // make data for acknowledge - id is snapshot
+    Package data {.type=Package::Type::ACK_SNAPSHOT, .id=snapshot};
+
+    // send
+    if (not send_package(data)) return std::nullopt;
+
+    m_acknowledged_snapshot = snapshot;
+    return snapshot;
+}
+
+std::optional<bool> Network::send_fec_flush () {
+    if (not m_is_connected_to_server or not m_fec_encoder.has_value()) return std::nullopt;
+
+    for (auto& datagram : m_fec_encoder->flush(FEC_FLUSH_TIMEOUT)) {
+        if (not send_buffer(datagram)) return false;
+    }
+    return true;
+}
+
+
 // ========================================================
 // helpers
 // ========================================================
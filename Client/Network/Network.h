@@ -1,9 +1,14 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <compact_state.h>
 #include <map>
+#include <packet_fec.h>
 #include <vector>
 #include <winsock2.h>
 #include <Ws2tcpip.h>
@@ -38,10 +43,12 @@ public:
         MESSAGE       =  1,
         GET_OTHER     =  2,
         FINISH        =  3,
-        BREAK_SESSION =  4
+        BREAK_SESSION =  4,
+        ACK_SNAPSHOT  =  5, // id - snapshot client has, baseline of next pushed deltas (0 - none)
+        COMPACT_MESSAGE = 6 // MESSAGE of compact session - id (varint) and quantized state
     };
     inline static const int MIN_TYPE = 0;
-    inline static const int MAX_TYPE = 4;
+    inline static const int MAX_TYPE = 6;
 
     struct Package_Payload {
         double x   = 0;
@@ -57,6 +64,9 @@ public:
     Type type = Type::EMPTY;
     std::optional<id_game_t> id = std::nullopt;
     std::optional<Package_Payload> payload = std::nullopt;
+    std::optional<custom_utils::Fec_config> fec = std::nullopt; // LOGIN - asks server for fec of answers
+    std::optional<custom_utils::Compact_config> compact = std::nullopt; // LOGIN - asks server for compact state
+    std::optional<custom_utils::Compact_state> compact_state = std::nullopt; // COMPACT_MESSAGE - instead of payload
 };
 
 
@@ -70,6 +80,9 @@ public:
         OTHER                 = 2,
         FINISH                = 3,
         BREAK_SESSION         = 4,
+        OTHER_DELTA           = 5, // changed fields of OTHER against snapshot acknowledged by client
+        OTHER_COMPACT         = 6, // OTHER and OTHER_DELTA of compact session - parsed as them
+        OTHER_DELTA_COMPACT   = 7,
     };
 public:
     struct Finish {
@@ -91,12 +104,17 @@ public:
     struct Other {
         Other_Payload payload;
         uint64_t id;
+        uint8_t  changed = ALL_FIELDS; // OTHER_DELTA - bit of every field of payload (x, y, dx, dy, ddx, ddy, time), 0 - player left
     };
+    inline static const uint8_t ALL_FIELDS = 0x7f;
 public:
     Type type = Type::BAD_FORMED;
     std::optional<id_game_t> id = std::nullopt;
+    std::optional<id_game_t> baseline = std::nullopt; // OTHER_DELTA - snapshot the delta is against
     std::optional<Finish> finish = std::nullopt;
     std::optional<std::vector<Other>> other = std::nullopt;
+    bool is_compact = false; // REGISTERED_ANSWER - server accepted compact state
+    bool is_pushing = false; // REGISTERED_ANSWER - server pushes snapshots after its ticks
 };
 
 
@@ -107,15 +125,37 @@ public:
     Network (const Network& network) = delete;
 
     [[nodiscard]] bool is_connected () const;
+    [[nodiscard]] bool is_pushed    () const; // snapshots are pushed by server - send_ask_other isn't needed
+
+    /**
+     * @brief fec of send_message and of snapshots pushed by server (or answers to send_ask_other) - used by sessions started after the call
+     *        (std::nullopt - no fec)
+     */
+    void set_fec (std::optional<custom_utils::Fec_config> config);
+    /**
+     * @brief compact state of send_message and snapshots (map_width, map_height - tiles of map) - used by sessions started after the call
+     *        session_start is set by send_connection, compact state is used only when server accepts it (std::nullopt - doubles)
+     */
+    void set_compact (std::optional<custom_utils::Compact_config> config);
 
 public:
     std::optional<Answer>    get_answer         ();
 
     std::optional<bool>      send_connection    ();
     std::optional<bool>      send_disconnection ();
-    std::optional<id_game_t> send_ask_other     ();
+    std::optional<id_game_t> send_ask_other     (); // only for server without push (is_pushed)
     std::optional<id_game_t> send_message       (const Package::Package_Payload& payload);
     std::optional<id_game_t> send_finish        (const Package::Package_Payload& payload);
+    /**
+     * @brief acknowledges latest snapshot got by get_answer - next pushed snapshots are deltas against it
+     * @return std::nullopt when there is no new snapshot since last call
+     */
+    std::optional<id_game_t> send_snapshot_acknowledge ();
+    /**
+     * @brief parity of fec group which waits for messages longer than FEC_FLUSH_TIMEOUT (messages are sent rarely)
+     * @return std::nullopt when session has no fec
+     */
+    std::optional<bool>      send_fec_flush ();
 
 public:
     static std::optional<std::map<id_game_t, Answer::Other_Payload>> parse_type_other_answer (const Answer& answer);
@@ -128,12 +168,18 @@ private:
 
 private:
     static bool decode_message (std::vector<uint8_t>& message);
-    static std::optional<Answer> parse_answer (const std::vector<uint8_t>& message);
+    // compact - config of compact session, compact answers are bad formed without it
+    static std::optional<Answer> parse_answer (const std::vector<uint8_t>& message, const std::optional<custom_utils::Compact_config>& compact = std::nullopt);
+    static bool parse_compact_other (std::span<const uint8_t> message, size_t data_disposition, const custom_utils::Compact_config& compact, Answer& answer);
+    std::optional<Answer> read_answer (const std::vector<uint8_t>& message); // parse and update state of session
+    std::optional<Answer> apply_delta (const Answer& delta); // OTHER of whole snapshot, std::nullopt - baseline isn't kept
+    void store_snapshot (const Answer& answer);
 
 private:
     static bool encode_message (std::vector<uint8_t>& message);
     static void serialize_package (const Package& package, std::vector<uint8_t>& buffer); // helper for send_answer
     bool send_package (const Package& package);
+    bool send_buffer  (std::vector<uint8_t>& buffer);
 
 private:
     addrinfo*     m_server_address;
@@ -143,6 +189,22 @@ private:
     bool          m_is_client_running      = true;
     bool          m_is_connected_to_server = false;
     id_game_t     m_next_package_id        = 0;
+
+    static constexpr std::chrono::milliseconds FEC_FLUSH_TIMEOUT = std::chrono::milliseconds(250); // messages are sent every 100 ms
+    std::optional<custom_utils::Fec_config>  m_fec_config        = std::nullopt;
+    std::optional<custom_utils::Fec_encoder> m_fec_encoder       = std::nullopt; // used by send thread
+    custom_utils::Fec_decoder                m_fec_decoder;                      // used by receive thread
+    std::deque<std::vector<uint8_t>>         m_restored_messages;                // decoded answers restored by fec
+
+    std::optional<custom_utils::Compact_config> m_compact_config = std::nullopt; // asked by login
+    std::atomic<bool>                           m_is_compact     = false;        // server accepted it
+    std::atomic<bool>                           m_is_pushed      = false;        // told by REGISTERED_ANSWER
+
+    // snapshots pushed by server - baselines of its deltas
+    static constexpr size_t SNAPSHOT_HISTORY = 64; // more than server keeps - its baseline is always here
+    std::deque<std::pair<id_game_t, std::vector<Answer::Other>>> m_snapshots;              // used by receive thread
+    std::atomic<id_game_t>                                       m_last_snapshot     = 0;  // got by receive thread
+    id_game_t                                                    m_acknowledged_snapshot = 0; // used by send thread
 };
 
 
@@ -0,0 +1,193 @@
+#ifndef COMPACT_STATE_H
+#define COMPACT_STATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * Quantized state of player - negotiated at LOGIN instead of doubles of MESSAGE and OTHER answers
+ *  - position: fixed point over bounds of map (uint16 - sub pixel for maps up to 2048 tiles)
+ *  - speed: 1/16 px/s (int16), acceleration: 32 px/s^2 (int8)
+ *  - time: ms since session start of client (zigzag varint)
+ * Fields are big endian, in order of mask bits: x, y, dx, dy, ddx, ddy, time
+ */
+namespace custom_utils {
+    inline constexpr double  COMPACT_TILE_SIZE          = 32;   // pixels of tile
+    inline constexpr double  COMPACT_SPEED_STEP         = 1.0 / 16;
+    inline constexpr double  COMPACT_ACCELERATION_STEP  = 32;
+    inline constexpr uint8_t COMPACT_ALL_FIELDS         = 0x7f;
+    inline constexpr size_t  COMPACT_CONFIG_SIZE        = 2 * sizeof(uint16_t) + sizeof(uint64_t);
+    inline constexpr size_t  COMPACT_STATE_MAX_SIZE     = 4 * sizeof(uint16_t) + 2 * sizeof(int8_t) + 10; // time - varint of 64 bits
+
+    // LOGIN - client asks for compact state of its session
+    struct Compact_config {
+        uint16_t map_width     = 0; // tiles
+        uint16_t map_height    = 0;
+        uint64_t session_start = 0; // ms - times of session are sent relative to it
+    };
+
+    struct Compact_state {
+        uint16_t x    = 0;
+        uint16_t y    = 0;
+        int16_t  dx   = 0;
+        int16_t  dy   = 0;
+        int8_t   ddx  = 0;
+        int8_t   ddy  = 0;
+        int64_t  time = 0;
+    };
+
+    // ===================================
+
+    inline void write_varint (uint64_t value, std::vector<uint8_t>& result) {
+        while (value >= 0x80) {
+            result.push_back(uint8_t(value | 0x80));
+            value >>= 7;
+        }
+        result.push_back(uint8_t(value));
+    }
+
+    /**
+     * @return std::nullopt when data ends before last byte (or value is longer than 64 bits)
+     */
+    inline std::optional<uint64_t> read_varint (std::span<const uint8_t> data, size_t& offset) {
+        uint64_t value = 0;
+        for (unsigned int shift = 0; shift < 64 and offset < data.size(); shift += 7) {
+            uint8_t byte = data[offset++];
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (not (byte & 0x80)) return value;
+        }
+        return std::nullopt;
+    }
+
+    inline uint64_t zigzag_encode (int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+    inline int64_t  zigzag_decode (uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+    // ===================================
+
+    inline bool is_valid_compact_config (const Compact_config& config) {
+        return config.map_width != 0 and config.map_height != 0;
+    }
+
+    inline void write_compact_config (const Compact_config& config, std::vector<uint8_t>& result) {
+        for (int shift = 8; shift >= 0; shift -= 8) result.push_back(uint8_t(config.map_width >> shift));
+        for (int shift = 8; shift >= 0; shift -= 8) result.push_back(uint8_t(config.map_height >> shift));
+        for (int shift = 56; shift >= 0; shift -= 8) result.push_back(uint8_t(config.session_start >> shift));
+    }
+
+    inline std::optional<Compact_config> read_compact_config (std::span<const uint8_t> data) {
+        if (data.size() != COMPACT_CONFIG_SIZE) return std::nullopt;
+
+        Compact_config config;
+        config.map_width  = uint16_t(data[0] << 8 | data[1]);
+        config.map_height = uint16_t(data[2] << 8 | data[3]);
+        for (size_t i = 4; i < COMPACT_CONFIG_SIZE; ++i) config.session_start = config.session_start << 8 | data[i];
+
+        if (not is_valid_compact_config(config)) return std::nullopt;
+        return config;
+    }
+
+    // ===================================
+
+    template <class Integer>
+    Integer quantize (double value, double step) {
+        double steps = std::round(value / step);
+        if (not (steps >= double(std::numeric_limits<Integer>::min()))) return std::numeric_limits<Integer>::min(); // nan too
+        return Integer(std::min(steps, double(std::numeric_limits<Integer>::max())));
+    }
+
+    inline double position_step (uint16_t tiles) {
+        return tiles * COMPACT_TILE_SIZE / std::numeric_limits<uint16_t>::max();
+    }
+
+    /**
+     * @brief State - x, y, dx, dy, ddx, ddy (double) and time (ms) members, positions outside of map are clamped to it
+     */
+    template <class State>
+    Compact_state quantize_state (const Compact_config& config, const State& state) {
+        return Compact_state{
+            .x    = quantize<uint16_t>(state.x, position_step(config.map_width)),
+            .y    = quantize<uint16_t>(state.y, position_step(config.map_height)),
+            .dx   = quantize<int16_t>(state.dx, COMPACT_SPEED_STEP),
+            .dy   = quantize<int16_t>(state.dy, COMPACT_SPEED_STEP),
+            .ddx  = quantize<int8_t>(state.ddx, COMPACT_ACCELERATION_STEP),
+            .ddy  = quantize<int8_t>(state.ddy, COMPACT_ACCELERATION_STEP),
+            .time = int64_t(uint64_t(state.time) - config.session_start),
+        };
+    }
+
+    template <class State>
+    void dequantize_state (const Compact_config& config, const Compact_state& compact, State& state) {
+        state.x    = compact.x * position_step(config.map_width);
+        state.y    = compact.y * position_step(config.map_height);
+        state.dx   = compact.dx * COMPACT_SPEED_STEP;
+        state.dy   = compact.dy * COMPACT_SPEED_STEP;
+        state.ddx  = compact.ddx * COMPACT_ACCELERATION_STEP;
+        state.ddy  = compact.ddy * COMPACT_ACCELERATION_STEP;
+        state.time = config.session_start + uint64_t(compact.time);
+    }
+
+    /**
+     * @return mask of fields which differ
+     */
+    inline uint8_t changed_fields (const Compact_state& a, const Compact_state& b) {
+        return uint8_t((a.x   != b.x)   << 0 | (a.y   != b.y)   << 1 |
+                       (a.dx  != b.dx)  << 2 | (a.dy  != b.dy)  << 3 |
+                       (a.ddx != b.ddx) << 4 | (a.ddy != b.ddy) << 5 |
+                       (a.time != b.time) << 6);
+    }
+
+    /**
+     * @brief fields of mask (COMPACT_ALL_FIELDS - whole state)
+     */
+    inline void write_compact_state (const Compact_state& state, uint8_t fields, std::vector<uint8_t>& result) {
+        auto write_16 = [&](uint16_t value) { result.push_back(uint8_t(value >> 8)); result.push_back(uint8_t(value)); };
+
+        if (fields & (1u << 0)) write_16(state.x);
+        if (fields & (1u << 1)) write_16(state.y);
+        if (fields & (1u << 2)) write_16(uint16_t(state.dx));
+        if (fields & (1u << 3)) write_16(uint16_t(state.dy));
+        if (fields & (1u << 4)) result.push_back(uint8_t(state.ddx));
+        if (fields & (1u << 5)) result.push_back(uint8_t(state.ddy));
+        if (fields & (1u << 6)) write_varint(zigzag_encode(state.time), result);
+    }
+
+    /**
+     * @brief fields of mask are read into state, others are kept
+     * @return false when data ends before last field
+     */
+    inline bool read_compact_state (std::span<const uint8_t> data, size_t& offset, uint8_t fields, Compact_state& state) {
+        auto read_16 = [&](uint16_t& value) {
+            if (offset + sizeof(uint16_t) > data.size()) return false;
+            value = uint16_t(data[offset] << 8 | data[offset + 1]);
+            offset += sizeof(uint16_t);
+            return true;
+        };
+        auto read_8 = [&](int8_t& value) {
+            if (offset >= data.size()) return false;
+            value = int8_t(data[offset++]);
+            return true;
+        };
+
+        uint16_t value;
+        if (fields & (1u << 0) and not read_16(state.x)) return false;
+        if (fields & (1u << 1) and not read_16(state.y)) return false;
+        if (fields & (1u << 2)) { if (not read_16(value)) return false; state.dx = int16_t(value); }
+        if (fields & (1u << 3)) { if (not read_16(value)) return false; state.dy = int16_t(value); }
+        if (fields & (1u << 4) and not read_8(state.ddx)) return false;
+        if (fields & (1u << 5) and not read_8(state.ddy)) return false;
+        if (fields & (1u << 6)) {
+            std::optional<uint64_t> time = read_varint(data, offset);
+            if (not time.has_value()) return false;
+            state.time = zigzag_decode(time.value());
+        }
+        return true;
+    }
+}
+
+#endif // COMPACT_STATE_H
@@ -0,0 +1,224 @@
+#include "crc32.h"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+    #define CRC32_HAS_PCLMUL_KERNEL 1
+    #include <cpuid.h>
+    #include <immintrin.h>
+#else
+    #define CRC32_HAS_PCLMUL_KERNEL 0
+#endif
+
+using Crc32_tables = std::array<std::array<uint32_t, UINT8_MAX + 1>, 16>;
+
+// tables[k][byte] - crc of byte followed by k zero bytes (tables[0] - usual byte table)
+consteval Crc32_tables make_tables () {
+    Crc32_tables result{};
+
+    for (uint16_t control_byte_overflow = 0; control_byte_overflow <= UINT8_MAX; ++control_byte_overflow) {
+        auto control_byte = static_cast<uint8_t>(control_byte_overflow); // using overflow cause iterator has to be > than UINT8_MAX
+        auto xor_result = static_cast<uint32_t>(control_byte << 24); // 32 - 8 = 24
+
+        for (short bit = 0; bit < 8; ++bit) {
+            if ((xor_result & 0x80000000) == 0) {
+                xor_result <<= 1;
+                continue;
+            }
+            xor_result = (xor_result << 1) ^ custom_utils::CRC32_POLYNOMIAL;
+        }
+
+        result[0][control_byte] = xor_result;
+    }
+
+    for (size_t k = 1; k < result.size(); ++k) {
+        for (size_t byte = 0; byte <= UINT8_MAX; ++byte) {
+            uint32_t previous = result[k - 1][byte];
+            result[k][byte] = (previous << 8) ^ result[0][previous >> 24];
+        }
+    }
+
+    return result;
+}
+
+static constexpr Crc32_tables TABLES = make_tables();
+
+const std::array<uint32_t, UINT8_MAX + 1>& custom_utils::crc32_table () {
+    return TABLES[0];
+}
+
+static uint32_t load_be32 (const uint8_t* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    if constexpr (std::endian::native == std::endian::little) value = std::byteswap(value);
+    return value;
+}
+
+// ---------------------------------------------------
+// table kernels
+// ---------------------------------------------------
+
+uint32_t custom_utils::crc32_update_table (uint32_t crc, std::span<const uint8_t> data) {
+    for (uint8_t byte : data) {
+        crc = (crc << 8) ^ TABLES[0][byte ^ uint8_t(crc >> 24)]; // 24 = 32 - 8, uint32_t >> 24 = uint8_t
+    }
+    return crc;
+}
+
+uint32_t custom_utils::crc32_update_slice_8 (uint32_t crc, std::span<const uint8_t> data) {
+    const uint8_t* ptr = data.data();
+    size_t size = data.size();
+
+    for (; size >= 8; ptr += 8, size -= 8) {
+        crc ^= load_be32(ptr);
+        crc = TABLES[7][crc >> 24] ^ TABLES[6][(crc >> 16) & 0xFF] ^ TABLES[5][(crc >> 8) & 0xFF] ^ TABLES[4][crc & 0xFF] ^
+              TABLES[3][ptr[4]]    ^ TABLES[2][ptr[5]]             ^ TABLES[1][ptr[6]]            ^ TABLES[0][ptr[7]];
+    }
+
+    return crc32_update_table(crc, {ptr, size});
+}
+
+uint32_t custom_utils::crc32_update_slice_16 (uint32_t crc, std::span<const uint8_t> data) {
+    const uint8_t* ptr = data.data();
+    size_t size = data.size();
+
+    for (; size >= 16; ptr += 16, size -= 16) {
+        crc ^= load_be32(ptr);
+        crc = TABLES[15][crc >> 24] ^ TABLES[14][(crc >> 16) & 0xFF] ^ TABLES[13][(crc >> 8) & 0xFF] ^ TABLES[12][crc & 0xFF] ^
+              TABLES[11][ptr[4]]    ^ TABLES[10][ptr[5]]             ^ TABLES[9][ptr[6]]              ^ TABLES[8][ptr[7]]    ^
+              TABLES[7][ptr[8]]     ^ TABLES[6][ptr[9]]              ^ TABLES[5][ptr[10]]             ^ TABLES[4][ptr[11]]   ^
+              TABLES[3][ptr[12]]    ^ TABLES[2][ptr[13]]             ^ TABLES[1][ptr[14]]             ^ TABLES[0][ptr[15]];
+    }
+
+    return crc32_update_slice_8(crc, {ptr, size});
+}
+
+// ---------------------------------------------------
+// carry-less multiplication kernel
+// ---------------------------------------------------
+
+// x^power mod polynomial
+consteval uint64_t x_power_mod (size_t power) {
+    uint32_t result = 1;
+    for (size_t i = 0; i < power; ++i) {
+        bool has_overflow = (result & 0x80000000) != 0;
+        result <<= 1;
+        if (has_overflow) result ^= custom_utils::CRC32_POLYNOMIAL;
+    }
+    return result;
+}
+
+#if CRC32_HAS_PCLMUL_KERNEL
+
+// value * x^bits (mod polynomial) - value is 128 bit polynomial, result fits 128 bits (96 bits are used)
+// constants: high - x^(bits + 64) mod polynomial, low - x^bits mod polynomial
+__attribute__((target("pclmul,ssse3")))
+static __m128i fold (__m128i value, __m128i constants) {
+    return _mm_xor_si128(_mm_clmulepi64_si128(value, constants, 0x11), _mm_clmulepi64_si128(value, constants, 0x00));
+}
+
+// 16 bytes as polynomial - first byte is the highest one
+__attribute__((target("pclmul,ssse3")))
+static __m128i load_block (const uint8_t* data) {
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), reverse);
+}
+
+__attribute__((target("pclmul,ssse3")))
+static void store_block (uint8_t* data, __m128i value) {
+    const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), _mm_shuffle_epi8(value, reverse));
+}
+
+__attribute__((target("pclmul,ssse3")))
+uint32_t custom_utils::crc32_update_pclmul (uint32_t crc, std::span<const uint8_t> data) {
+    // folding setup isn't worth it for small data
+    if (data.size() < 64) return crc32_update_slice_8(crc, data);
+
+    const __m128i fold_128 = _mm_set_epi64x(x_power_mod(128 + 64), x_power_mod(128));
+    const __m128i fold_512 = _mm_set_epi64x(x_power_mod(512 + 64), x_power_mod(512));
+
+    const uint8_t* ptr = data.data();
+    size_t size = data.size();
+
+    // crc of processed data is the same as xor of its value with first bytes of the next data
+    __m128i x0 = _mm_xor_si128(load_block(ptr), _mm_set_epi32(static_cast<int>(crc), 0, 0, 0));
+    __m128i x1 = load_block(ptr + 16);
+    __m128i x2 = load_block(ptr + 32);
+    __m128i x3 = load_block(ptr + 48);
+    ptr  += 64;
+    size -= 64;
+
+    // 4 independent folds by 512 bits
+    for (; size >= 64; ptr += 64, size -= 64) {
+        x0 = _mm_xor_si128(fold(x0, fold_512), load_block(ptr));
+        x1 = _mm_xor_si128(fold(x1, fold_512), load_block(ptr + 16));
+        x2 = _mm_xor_si128(fold(x2, fold_512), load_block(ptr + 32));
+        x3 = _mm_xor_si128(fold(x3, fold_512), load_block(ptr + 48));
+    }
+
+    // join into one value
+    x1 = _mm_xor_si128(fold(x0, fold_128), x1);
+    x2 = _mm_xor_si128(fold(x1, fold_128), x2);
+    x3 = _mm_xor_si128(fold(x2, fold_128), x3);
+
+    for (; size >= 16; ptr += 16, size -= 16) {
+        x3 = _mm_xor_si128(fold(x3, fold_128), load_block(ptr));
+    }
+
+    // crc of folded value (with zero initial value) is crc of all processed data
+    alignas(16) std::array<uint8_t, 16> folded;
+    store_block(folded.data(), x3);
+    crc = crc32_update_slice_8(0, folded);
+
+    return crc32_update_slice_8(crc, {ptr, size});
+}
+
+#else
+
+uint32_t custom_utils::crc32_update_pclmul (uint32_t crc, std::span<const uint8_t> data) {
+    return crc32_update_slice_16(crc, data);
+}
+
+#endif
+
+// ---------------------------------------------------
+// dispatch
+// ---------------------------------------------------
+
+bool custom_utils::crc32_is_supported (Crc32_kernel kernel) {
+    if (kernel != Crc32_kernel::PCLMUL) return true;
+
+#if CRC32_HAS_PCLMUL_KERNEL
+    unsigned int eax, ebx, ecx, edx;
+    if (not __get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+    return (ecx & bit_PCLMUL) != 0 and (ecx & bit_SSSE3) != 0;
+#else
+    return false;
+#endif
+}
+
+custom_utils::Crc32_kernel custom_utils::crc32_selected_kernel () {
+    static const Crc32_kernel kernel = crc32_is_supported(Crc32_kernel::PCLMUL) ? Crc32_kernel::PCLMUL : Crc32_kernel::SLICE_16;
+    return kernel;
+}
+
+uint32_t custom_utils::crc32_update (Crc32_kernel kernel, uint32_t crc, std::span<const uint8_t> data) {
+    switch (kernel) {
+        case Crc32_kernel::TABLE:    return crc32_update_table(crc, data);
+        case Crc32_kernel::SLICE_8:  return crc32_update_slice_8(crc, data);
+        case Crc32_kernel::SLICE_16: return crc32_update_slice_16(crc, data);
+        case Crc32_kernel::PCLMUL:   return crc32_update_pclmul(crc, data);
+    }
+    return crc32_update_table(crc, data);
+}
+
+uint32_t custom_utils::crc32_update (uint32_t crc, std::span<const uint8_t> data) {
+    // folding doesn't pay off for small packages
+    if (data.size() < 64) return crc32_update_slice_8(crc, data);
+    return crc32_update(crc32_selected_kernel(), crc, data);
+}
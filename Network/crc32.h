@@ -0,0 +1,70 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * CRC-32 used by error_repairing: polynomial 0x04C11DB7, not reflected (most significant bit first),
+ * initial value 0xFFFFFFFF, no final xor
+ * All kernels give the same result - they differ only in speed
+ */
+namespace custom_utils {
+    inline constexpr uint32_t CRC32_POLYNOMIAL = 0x04C11DB7;
+    inline constexpr uint32_t CRC32_INITIAL    = 0xFFFFFFFF;
+
+    enum class Crc32_kernel : uint8_t {
+        TABLE    = 0, // byte at a time (reference for other kernels)
+        SLICE_8  = 1, // 8 bytes at a time
+        SLICE_16 = 2, // 16 bytes at a time
+        PCLMUL   = 3, // carry-less multiplication folding (x86 with PCLMULQDQ and SSSE3)
+    };
+
+    const std::array<uint32_t, UINT8_MAX + 1>& crc32_table ();
+
+    /**
+     * @brief continue calculation of crc from value crc (CRC32_INITIAL for new data)
+     */
+    uint32_t crc32_update_table    (uint32_t crc, std::span<const uint8_t> data);
+    uint32_t crc32_update_slice_8  (uint32_t crc, std::span<const uint8_t> data);
+    uint32_t crc32_update_slice_16 (uint32_t crc, std::span<const uint8_t> data);
+    /**
+     * @brief has to be called only when crc32_is_supported(Crc32_kernel::PCLMUL)
+     */
+    uint32_t crc32_update_pclmul   (uint32_t crc, std::span<const uint8_t> data);
+
+    [[nodiscard]] bool crc32_is_supported (Crc32_kernel kernel);
+    /**
+     * @brief fastest kernel of current cpu (chosen once - by cpuid)
+     */
+    [[nodiscard]] Crc32_kernel crc32_selected_kernel ();
+    /**
+     * @brief uses crc32_selected_kernel
+     */
+    uint32_t crc32_update (uint32_t crc, std::span<const uint8_t> data);
+    uint32_t crc32_update (Crc32_kernel kernel, uint32_t crc, std::span<const uint8_t> data);
+
+    /**
+     * crc of data given in parts - parts are checksummed while they are written, without copying them together
+     */
+    class Crc32 {
+    public:
+        Crc32& update (std::span<const uint8_t> data) {
+            m_crc = crc32_update(m_crc, data);
+            return *this;
+        }
+
+        /**
+         * @brief crc of all parts since construction (or reset), the same as crc32_update(CRC32_INITIAL, all parts)
+         */
+        [[nodiscard]] uint32_t finish () const { return m_crc; }
+        void reset () { m_crc = CRC32_INITIAL; }
+
+    private:
+        uint32_t m_crc = CRC32_INITIAL;
+    };
+}
+
+#endif // CRC32_H
@@ -1,29 +1,25 @@
 #include "error_repairing.h"
+#include "crc32.h"
+#include "fixed_package_codec.h"
+#include "interleaved_secded.h"
+#include "packed_hamming.h"
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <list>
 #include <optional>
-#include <synchapi.h>
+#include <span>
 #include <vector>
 
 
 std::optional<size_t> custom_utils::amount_of_redundant_bits (size_t data_size) {
-    // FIXME: still not fully safe due to usage of redundant_bits
-    if (data_size > UINT64_MAX - 1) return std::nullopt;
-
-    auto redundant_bits = static_cast<size_t>(std::ceil(std::log(data_size + 1)));
-
-    while (std::pow(2, redundant_bits) < static_cast<double>(data_size + 1 + redundant_bits)) {
-        // could be optimized - maybe the redundant bits update in cycle always been called once
-        // (at least consider maybe for std::log increment) - remove if statement of while cycle
-        // redundant_bits = static_cast<size_t>(std::ceil(std::log(data_size + redundant_bits + 1)));
-        ++redundant_bits;
-    }
-    return redundant_bits;
+    // data and redundant bits have to fit into size_t
+    if (data_size > SIZE_MAX / 2) return std::nullopt;
+    return hamming_parity_bits(data_size);
 }
 
 
@@ -159,135 +155,410 @@ std::list<bool> custom_utils::byte_array_to_binary_list (const std::vector<uint8
 
 // ---------------------------------------------------
 
-consteval std::array<uint32_t, UINT8_MAX + 1> make_table () {
-    std::array<uint32_t, UINT8_MAX + 1> result;
-    const uint32_t C = 0x04C11DB7; // 1 1000 0000 0000 0101 -> 1000 0000 0000 0101 = 04C11DB7
+const std::array<uint32_t, UINT8_MAX + 1>& custom_utils::get_table () {
+    return crc32_table();
+}
 
-    for (uint16_t control_byte_overflow = 0; control_byte_overflow <= UINT8_MAX; ++control_byte_overflow) {
-        auto control_byte = static_cast<uint8_t>(control_byte_overflow); // using overflow cause iterator has to be > than UINT8_MAX
-        auto xor_result = static_cast<uint32_t>(control_byte << 24); // 32 - 8 = 24
+// ---------------------------------------------------
 
-        for (short bit = 0; bit < 8; ++bit) {
-            if ((xor_result & 0x80000000) == 0) {
-                xor_result <<= 1;
-                continue;
-            }
-            xor_result = (xor_result << 1) ^ C;
-        }
+// bit at a time - reference for calculate_checksum
+uint32_t custom_utils::calculate_checksum_slow (const std::vector<uint8_t>& data) {
+    const uint32_t C = CRC32_POLYNOMIAL;
+    uint32_t result = CRC32_INITIAL;
 
-        result[control_byte] = xor_result;
+    for (size_t i = 0; i < data.size() * 8; ++i) {
+        bool bit    = (data[i / 8] & (0x80 >> (i % 8))) != 0;
+        bool to_xor = ((result & 0x80000000) != 0) != bit;
+        result <<= 1;
+        if (to_xor) result ^= C;
     }
-
     return result;
 }
 
-const std::array<uint32_t, UINT8_MAX + 1>& custom_utils::get_table () {
-    static const auto table = make_table();
-    return table;
+uint32_t custom_utils::calculate_checksum (const std::vector<uint8_t>& data) {
+    return crc32_update(CRC32_INITIAL, data);
+}
+
+uint32_t custom_utils::calculate_checksum (std::span<const uint8_t> data) {
+    return crc32_update(CRC32_INITIAL, data);
 }
 
 // ---------------------------------------------------
 
-uint32_t custom_utils::calculate_checksum_slow (const std::vector<uint8_t>& data) {
-    const uint32_t C = 0x04C11DB7;
-    uint32_t result = 0xFFFFFFFF;
-    bool* a = reinterpret_cast<bool*>(const_cast<unsigned char*>(data.data()));
-
-    for (uint32_t i = 0; i < data.size() * 8; ++i) {
-        bool to_xor = (result & 0x80000000) != 0;
-        bool x = a[i / 8];
-        x = x & (0x80 >> (i % 8));
-        result = (result << 1) | x;
-        if (to_xor) result ^= C;
+bool custom_utils::encode_package (std::vector<uint8_t>& package) {
+    std::optional<size_t> size = encoded_package_size(package.size());
+    if (not size.has_value()) return false;
+
+    std::vector<uint8_t> encoded(size.value());
+    if (not encode_package_into(package, encoded).has_value()) return false;
+
+    // result
+    package = std::move(encoded);
+    return true;
+}
+
+bool custom_utils::decode_package (std::vector<uint8_t>& package) {
+    std::optional<size_t> size = decode_package_in_place(package);
+    if (not size.has_value()) return false;
+
+    package.resize(size.value()); // cause repair codes and checksum were removed
+    return true;
+}
+
+// ---------------------------------------------------
+
+std::optional<size_t> custom_utils::encoded_package_size (size_t package_size) {
+    // data has to fit into size_t in bits (with checksum and repair codes)
+    if (package_size > (SIZE_MAX - 128) / 8 - sizeof(uint32_t)) return std::nullopt;
+    return hamming_encoded_size(package_size + sizeof(uint32_t));
+}
+
+size_t custom_utils::decoded_package_size (size_t encoded_size) {
+    size_t size = hamming_decoded_size(encoded_size);
+    return size < sizeof(uint32_t) ? 0 : size - sizeof(uint32_t);
+}
+
+template <size_t N>
+static size_t encode_fixed (std::span<const uint8_t> package, std::span<uint8_t> result) {
+    using Codec = custom_utils::Fixed_package_codec<N>;
+    return Codec::encode(package.first<N>(), result.first<Codec::ENCODED_SIZE>());
+}
+
+template <size_t N>
+static std::optional<size_t> decode_fixed (std::span<uint8_t> package) {
+    using Codec = custom_utils::Fixed_package_codec<N>;
+    if (not Codec::decode(package.first<Codec::ENCODED_SIZE>())) return std::nullopt;
+    return N;
+}
+
+template <size_t N>
+static size_t encode_fixed (std::span<const uint8_t> package, uint32_t checksum, std::span<uint8_t> result) {
+    using Codec = custom_utils::Fixed_package_codec<N>;
+    return Codec::encode(package.first<N>(), checksum, result.first<Codec::ENCODED_SIZE>());
+}
+
+// result is big enough, checksum is crc of package
+static size_t encode_checked_package_into (std::span<const uint8_t> package, uint32_t checksum, std::span<uint8_t> result) {
+    // sizes of protocol messages - unrolled codec
+    switch (package.size()) {
+        case custom_utils::PACKAGE_SIZE_TYPE:         return encode_fixed<custom_utils::PACKAGE_SIZE_TYPE>(package, checksum, result);
+        case custom_utils::PACKAGE_SIZE_TYPE_ID:      return encode_fixed<custom_utils::PACKAGE_SIZE_TYPE_ID>(package, checksum, result);
+        case custom_utils::PACKAGE_SIZE_TYPE_ID_DATA: return encode_fixed<custom_utils::PACKAGE_SIZE_TYPE_ID_DATA>(package, checksum, result);
+        default: break;
     }
-    for (uint32_t i = 0; i < 32; ++i) {
-        bool to_xor = (result & 0x80000000) != 0;
-        result = (result << 1);
-        if (to_xor) result ^= C;
 
+    // part I: error check_sum - to check after reparing (big endian, so checksum of whole data becomes 0)
+    std::array<uint8_t, sizeof(checksum)> array_checksum = {
+        uint8_t(checksum >> 24), uint8_t(checksum >> 16), uint8_t(checksum >> 8), uint8_t(checksum)
+    };
+
+    // part II: repair code
+    return custom_utils::encode_repair_bytes(package, array_checksum, result);
+}
+
+std::optional<size_t> custom_utils::encode_package_into (std::span<const uint8_t> package, std::span<uint8_t> result) {
+    std::optional<size_t> size = encoded_package_size(package.size());
+    if (not size.has_value() or result.size() < size.value()) return std::nullopt;
+
+    // sizes of protocol messages - unrolled codec
+    switch (package.size()) {
+        case PACKAGE_SIZE_TYPE:         return encode_fixed<PACKAGE_SIZE_TYPE>(package, result);
+        case PACKAGE_SIZE_TYPE_ID:      return encode_fixed<PACKAGE_SIZE_TYPE_ID>(package, result);
+        case PACKAGE_SIZE_TYPE_ID_DATA: return encode_fixed<PACKAGE_SIZE_TYPE_ID_DATA>(package, result);
+        default: break;
     }
-    return result;
 
+    return encode_checked_package_into(package, calculate_checksum(package), result);
 }
 
-uint32_t custom_utils::calculate_checksum (const std::vector<uint8_t>& data) {
-    uint32_t result = 0xFFFFFFFF;
-    const auto& table = get_table();
-    for (uint8_t byte : data) {
-        result = (result << 8) ^ table[byte ^ uint8_t(result >> 24)]; // 24 = 32 - 8, uint32_t >> 24 = uint8_t
+std::optional<size_t> custom_utils::decode_package_in_place (std::span<uint8_t> package) {
+    // sizes of protocol messages - unrolled codec
+    switch (package.size()) {
+        case Fixed_package_codec<PACKAGE_SIZE_TYPE>::ENCODED_SIZE:         return decode_fixed<PACKAGE_SIZE_TYPE>(package);
+        case Fixed_package_codec<PACKAGE_SIZE_TYPE_ID>::ENCODED_SIZE:      return decode_fixed<PACKAGE_SIZE_TYPE_ID>(package);
+        case Fixed_package_codec<PACKAGE_SIZE_TYPE_ID_DATA>::ENCODED_SIZE: return decode_fixed<PACKAGE_SIZE_TYPE_ID_DATA>(package);
+        default: break;
     }
-    return result;
+
+    // part I: repair code
+    std::optional<size_t> size = decode_repair_bytes(package, package);
+    if (not size.has_value()) return std::nullopt;
+
+    // part II: error check_sum - check after repairing
+    std::span<const uint8_t> decoded = std::span<const uint8_t>(package).first(size.value());
+    if (decoded.size() < sizeof(uint32_t) or calculate_checksum(decoded) != 0) return std::nullopt;
+
+    // result - without checksum
+    return decoded.size() - sizeof(uint32_t);
 }
 
 // ---------------------------------------------------
 
-bool custom_utils::encode_package (std::vector<uint8_t>& package) {
-    // part I: error check_sum - to check after reparing
-    uint32_t checksum = calculate_checksum(package);
-    auto* array_checksum = reinterpret_cast<uint8_t*>(&checksum);
-    if (INT64_MAX - package.size() < sizeof(checksum)) return false;
+custom_utils::Packet_encoder& custom_utils::Packet_encoder::update (std::span<const uint8_t> data) {
+    if (m_is_checked) m_crc.update(data);
+    m_package.insert(m_package.end(), data.begin(), data.end());
+    return *this;
+}
+
+std::optional<size_t> custom_utils::Packet_encoder::finish (std::span<uint8_t> result) {
+    std::optional<size_t> size = encoded_size();
+    if (not size.has_value() or result.size() < size.value()) return std::nullopt;
+
+    if (not m_is_checked) m_crc.update(m_package);
+    size = encode_checked_package_into(m_package, m_crc.finish(), result);
+    reset();
+    return size;
+}
+
+bool custom_utils::Packet_encoder::finish (std::vector<uint8_t>& result) {
+    std::optional<size_t> size = encoded_size();
+    if (not size.has_value()) return false;
+
+    result.resize(size.value());
+    return finish(std::span(result)).has_value();
+}
 
-    for (auto* ptr = array_checksum + sizeof(checksum) - 1; ptr >= array_checksum; --ptr) {
-        package.push_back(*ptr);
+void custom_utils::Packet_encoder::reset () {
+    m_crc.reset();
+    m_package.clear();
+}
+
+// ---------------------------------------------------
+
+// nearest mode - modes differ in 8 bits, so up to 3 damaged bits are repaired
+static std::optional<custom_utils::Framing_mode> read_framing_mode (uint8_t byte) {
+    for (auto mode : {custom_utils::Framing_mode::WHOLE_PACKAGE, custom_utils::Framing_mode::INTERLEAVED_SECDED}) {
+        if (std::popcount(uint8_t(byte ^ static_cast<uint8_t>(mode))) <= 3) return mode;
     }
+    return std::nullopt;
+}
 
-    // part II: repair code
-    auto binary_package = byte_array_to_binary_list(package);
-    if (not encode_repair_data(binary_package)) return false;
+// interleaved words: package, zero completion to whole words, size of completion, checksum
+static constexpr size_t INTERLEAVED_TRAILER_SIZE = 1 + sizeof(uint32_t);
 
-    // result
-    package = binary_list_to_byte_array(binary_package);
-    return true;
+static size_t interleaved_completion (size_t package_size) {
+    return (8 - (package_size + INTERLEAVED_TRAILER_SIZE) % 8) % 8;
 }
-// 218:  1101 1010
-// 110:  0110 1110
 
-bool custom_utils::decode_package (std::vector<uint8_t>& package) {
-    // part I: repair code
-    auto binary_package = byte_array_to_binary_list(package);
-    bool ok = decode_repair_data(binary_package);
-    if (not ok) return false;
+std::optional<size_t> custom_utils::framed_package_size (size_t package_size, Framing_mode mode) {
+    std::optional<size_t> size = encoded_package_size(package_size); // the same limit for both modes
+    if (not size.has_value()) return std::nullopt;
+
+    if (mode == Framing_mode::INTERLEAVED_SECDED) {
+        size = interleaved_encoded_size(package_size + interleaved_completion(package_size) + INTERLEAVED_TRAILER_SIZE);
+    }
+    return 1 + size.value();
+}
+
+std::optional<size_t> custom_utils::encode_framed_package_into (std::span<const uint8_t> package, std::span<uint8_t> result, Framing_mode mode) {
+    std::optional<size_t> size = framed_package_size(package.size(), mode);
+    if (not size.has_value() or result.size() < size.value()) return std::nullopt;
+
+    result[0] = static_cast<uint8_t>(mode);
+    std::span<uint8_t> body = result.subspan(1);
+
+    if (mode == Framing_mode::WHOLE_PACKAGE) {
+        std::optional<size_t> body_size = encode_package_into(package, body);
+        if (not body_size.has_value()) return std::nullopt;
+        return 1 + body_size.value();
+    }
 
-    package = binary_list_to_byte_array(binary_package); // cause repair codes were removed
+    // part I: completion and error check_sum - checksum of whole words becomes 0
+    const size_t completion = interleaved_completion(package.size());
+    std::array<uint8_t, 7 + INTERLEAVED_TRAILER_SIZE> trailer{};
+    std::span<uint8_t> tail = std::span(trailer).first(completion + INTERLEAVED_TRAILER_SIZE);
+    tail[completion] = static_cast<uint8_t>(completion);
+
+    uint32_t checksum = crc32_update(calculate_checksum(package), tail.first(completion + 1));
+    tail[completion + 1] = uint8_t(checksum >> 24);
+    tail[completion + 2] = uint8_t(checksum >> 16);
+    tail[completion + 3] = uint8_t(checksum >> 8);
+    tail[completion + 4] = uint8_t(checksum);
+
+    // part II: repair code
+    return 1 + encode_interleaved_bytes(package, tail, body);
+}
+
+std::optional<custom_utils::Framed_package> custom_utils::decode_framed_package_in_place (std::span<uint8_t> package) {
+    if (package.empty()) return std::nullopt;
+
+    std::optional<Framing_mode> mode = read_framing_mode(package[0]);
+    if (not mode.has_value()) return std::nullopt;
+
+    if (mode.value() == Framing_mode::WHOLE_PACKAGE) {
+        std::optional<size_t> size = decode_package_in_place(package.subspan(1));
+        if (not size.has_value()) return std::nullopt;
+
+        std::ranges::copy(package.subspan(1, size.value()), package.begin());
+        return Framed_package{.mode=mode.value(), .size=size.value()};
+    }
+
+    // part I: repair code
+    std::optional<size_t> size = decode_interleaved_bytes(package.subspan(1), package);
+    if (not size.has_value() or size.value() < INTERLEAVED_TRAILER_SIZE) return std::nullopt;
 
     // part II: error check_sum - check after repairing
-    uint32_t checksum = calculate_checksum(package);
-    if (checksum != 0) return false;
+    std::span<const uint8_t> decoded = std::span<const uint8_t>(package).first(size.value());
+    if (calculate_checksum(decoded) != 0) return std::nullopt;
+
+    size_t completion = decoded[decoded.size() - INTERLEAVED_TRAILER_SIZE];
+    if (completion > 7 or completion + INTERLEAVED_TRAILER_SIZE > decoded.size()) return std::nullopt;
+
+    // result - without completion and checksum
+    return Framed_package{.mode=mode.value(), .size=decoded.size() - INTERLEAVED_TRAILER_SIZE - completion};
+}
 
-    package.resize(package.size() - sizeof(checksum)); // remove checksum from data
+bool custom_utils::encode_framed_package (std::vector<uint8_t>& package, Framing_mode mode) {
+    std::optional<size_t> size = framed_package_size(package.size(), mode);
+    if (not size.has_value()) return false;
+
+    std::vector<uint8_t> encoded(size.value());
+    if (not encode_framed_package_into(package, encoded, mode).has_value()) return false;
 
     // result
+    package = std::move(encoded);
     return true;
 }
 
+std::optional<custom_utils::Framing_mode> custom_utils::decode_framed_package (std::vector<uint8_t>& package) {
+    std::optional<Framed_package> decoded = decode_framed_package_in_place(package);
+    if (not decoded.has_value()) return std::nullopt;
+
+    package.resize(decoded->size); // cause mode, repair codes and checksum were removed
+    return decoded->mode;
+}
+
 // ---------------------------------------------------
 
-bool c_wrapped_custom_utils::encode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size) {
-    std::vector<uint8_t> package(ptr_data, ptr_data + size);
+size_t custom_utils::encode_packages_batch (std::span<const std::span<const uint8_t>> packages,
+                                            std::span<const std::span<uint8_t>> results,
+                                            std::span<std::optional<size_t>> result_sizes) {
+    const size_t count = std::min({packages.size(), results.size(), result_sizes.size()});
+    size_t amount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result_sizes[i] = encode_package_into(packages[i], results[i]);
+        if (result_sizes[i].has_value()) ++amount;
+    }
+    return amount;
+}
+
+size_t custom_utils::decode_packages_batch (std::span<const std::span<uint8_t>> packages, std::span<std::optional<size_t>> result_sizes) {
+    const size_t count = std::min(packages.size(), result_sizes.size());
+    size_t amount = 0;
+    for (size_t i = 0; i < count; ++i) {
+        result_sizes[i] = decode_package_in_place(packages[i]);
+        if (result_sizes[i].has_value()) ++amount;
+    }
+    return amount;
+}
+
+// ---------------------------------------------------
 
-    if (not custom_utils::encode_package(package)) return false;;
+bool c_wrapped_custom_utils::encode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size) {
+    std::optional<size_t> encoded_size = custom_utils::encoded_package_size(size);
+    if (not encoded_size.has_value()) return false;
 
-    *result = reinterpret_cast<uint8_t*>(malloc(package.size() * sizeof(uint8_t)));
-    *result_size = package.size();
+    *result = reinterpret_cast<uint8_t*>(malloc(encoded_size.value() * sizeof(uint8_t)));
+    if (*result == nullptr) return false;
 
-    std::ranges::copy(package, *result);
+    if (not encode_package_into_c_wrapped(ptr_data, size, *result, encoded_size.value(), result_size)) {
+        free(*result);
+        return false;
+    }
     return true;
 }
 
 bool c_wrapped_custom_utils::decode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size) {
     std::vector<uint8_t> package(ptr_data, ptr_data + size);
 
-    bool function_result = custom_utils::decode_package(package);
-    if (not function_result) return false;
+    std::optional<size_t> decoded_size = custom_utils::decode_package_in_place(package);
+    if (not decoded_size.has_value()) return false;
 
-    *result      = reinterpret_cast<uint8_t*>(malloc(package.size() * sizeof(uint8_t)));
-    *result_size = package.size();
+    *result      = reinterpret_cast<uint8_t*>(malloc(std::max<size_t>(decoded_size.value(), 1) * sizeof(uint8_t)));
+    *result_size = decoded_size.value();
+    if (*result == nullptr) return false;
 
-    std::ranges::copy(package, *result);
+    std::ranges::copy(std::span(package).first(decoded_size.value()), *result);
 
     return true;
 }
 
 void c_wrapped_custom_utils::free_c_wrapped (uint8_t* ptr_data) {
     free(ptr_data);
-}
\ No newline at end of file
+}
+
+size_t c_wrapped_custom_utils::encoded_package_size_c_wrapped (size_t size) {
+    return custom_utils::encoded_package_size(size).value_or(0);
+}
+
+bool c_wrapped_custom_utils::encode_package_into_c_wrapped (const uint8_t* ptr_data, size_t size, uint8_t* result, size_t result_capacity, size_t* result_size) {
+    std::optional<size_t> encoded_size = custom_utils::encode_package_into({ptr_data, size}, {result, result_capacity});
+    if (not encoded_size.has_value()) return false;
+
+    *result_size = encoded_size.value();
+    return true;
+}
+
+bool c_wrapped_custom_utils::decode_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, size_t* result_size) {
+    std::optional<size_t> decoded_size = custom_utils::decode_package_in_place({ptr_data, size});
+    if (not decoded_size.has_value()) return false;
+
+    *result_size = decoded_size.value();
+    return true;
+}
+
+size_t c_wrapped_custom_utils::framed_package_size_c_wrapped (size_t size, uint8_t mode) {
+    std::optional<custom_utils::Framing_mode> framing_mode = read_framing_mode(mode);
+    if (not framing_mode.has_value() or static_cast<uint8_t>(framing_mode.value()) != mode) return 0;
+
+    return custom_utils::framed_package_size(size, framing_mode.value()).value_or(0);
+}
+
+bool c_wrapped_custom_utils::encode_framed_package_into_c_wrapped (const uint8_t* ptr_data, size_t size, uint8_t mode, uint8_t* result, size_t result_capacity, size_t* result_size) {
+    std::optional<custom_utils::Framing_mode> framing_mode = read_framing_mode(mode);
+    if (not framing_mode.has_value() or static_cast<uint8_t>(framing_mode.value()) != mode) return false;
+
+    std::optional<size_t> encoded_size = custom_utils::encode_framed_package_into({ptr_data, size}, {result, result_capacity}, framing_mode.value());
+    if (not encoded_size.has_value()) return false;
+
+    *result_size = encoded_size.value();
+    return true;
+}
+
+bool c_wrapped_custom_utils::decode_framed_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t* mode, size_t* result_size) {
+    std::optional<custom_utils::Framed_package> decoded = custom_utils::decode_framed_package_in_place({ptr_data, size});
+    if (not decoded.has_value()) return false;
+
+    *mode        = static_cast<uint8_t>(decoded->mode);
+    *result_size = decoded->size;
+    return true;
+}
+
+size_t c_wrapped_custom_utils::encode_packages_batch_c_wrapped (const uint8_t* const* ptr_packages, const size_t* sizes, size_t count,
+                                                                uint8_t* const* results, const size_t* result_capacities, size_t* result_sizes) {
+    std::vector<std::span<const uint8_t>> packages(count);
+    std::vector<std::span<uint8_t>>       result_spans(count);
+    std::vector<std::optional<size_t>>    encoded_sizes(count);
+    for (size_t i = 0; i < count; ++i) {
+        packages[i]     = {ptr_packages[i], sizes[i]};
+        result_spans[i] = {results[i], result_capacities[i]};
+    }
+
+    size_t amount = custom_utils::encode_packages_batch(packages, result_spans, encoded_sizes);
+    for (size_t i = 0; i < count; ++i) result_sizes[i] = encoded_sizes[i].value_or(0);
+    return amount;
+}
+
+size_t c_wrapped_custom_utils::decode_packages_batch_c_wrapped (uint8_t* const* ptr_packages, const size_t* sizes, size_t count,
+                                                                size_t* result_sizes, bool* is_decoded) {
+    std::vector<std::span<uint8_t>>    packages(count);
+    std::vector<std::optional<size_t>> decoded_sizes(count);
+    for (size_t i = 0; i < count; ++i) packages[i] = {ptr_packages[i], sizes[i]};
+
+    size_t amount = custom_utils::decode_packages_batch(packages, decoded_sizes);
+    for (size_t i = 0; i < count; ++i) {
+        is_decoded[i]   = decoded_sizes[i].has_value();
+        result_sizes[i] = decoded_sizes[i].value_or(0);
+    }
+    return amount;
+}
@@ -1,8 +1,13 @@
+#ifndef ERROR_REPAIRING_H
+#define ERROR_REPAIRING_H
+
+#include "crc32.h"
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <list>
 #include <optional>
+#include <span>
 #include <vector>
 
 namespace custom_utils {
@@ -30,6 +35,7 @@ namespace custom_utils {
 
     const std::array<uint32_t, UINT8_MAX + 1>& get_table();
     uint32_t calculate_checksum      (const std::vector<uint8_t>& data);
+    uint32_t calculate_checksum      (std::span<const uint8_t> data);
     uint32_t calculate_checksum_slow (const std::vector<uint8_t>& data);
 
     // ----------------------------------
@@ -37,10 +43,136 @@ namespace custom_utils {
     bool encode_package (std::vector<uint8_t>& package);
     bool decode_package (std::vector<uint8_t>& package);
 
+    // ----------------------------------
+    // caller buffers - no allocation
+
+    /**
+     * @brief size of package_size bytes after encode_package (checksum + repair codes)
+     * @return std::nullopt if package_size is too big to be encoded
+     */
+    std::optional<size_t> encoded_package_size (size_t package_size);
+    /**
+     * @brief max size of package after decoding of encoded_size bytes
+     */
+    size_t decoded_package_size (size_t encoded_size);
+
+    /**
+     * @brief result has to be at least encoded_package_size(package.size()) bytes and must not overlap package
+     * @return amount of bytes written to result, std::nullopt when result is too small
+     */
+    std::optional<size_t> encode_package_into (std::span<const uint8_t> package, std::span<uint8_t> result);
+    /**
+     * @brief decodes in place - decoded package is placed at the beginning of package
+     * @return size of decoded package, std::nullopt when package is damaged
+     */
+    std::optional<size_t> decode_package_in_place (std::span<uint8_t> package);
+
+    /**
+     * package given in parts (fields of message, header and body) - checksum is calculated while parts are written,
+     * so encoding doesn't need another pass over package (the same result as encode_package_into)
+     */
+    class Packet_encoder {
+    public:
+        Packet_encoder& update (std::span<const uint8_t> data);
+
+        /**
+         * @brief package written since construction (or last finish/reset)
+         */
+        [[nodiscard]] std::span<const uint8_t> package () const { return m_package; }
+        [[nodiscard]] std::optional<size_t>    encoded_size () const { return encoded_package_size(m_package.size()); }
+
+        /**
+         * @brief encodes package into result and resets encoder (memory of package is kept for next one)
+         * @return amount of bytes written to result, std::nullopt when result is too small
+         */
+        std::optional<size_t> finish (std::span<uint8_t> result);
+        bool finish (std::vector<uint8_t>& result);
+        void reset ();
+        /**
+         * @brief is_checked false - parts aren't checksummed (package is taken by package(), e.g. into fec datagram with its own checksum),
+         *        finish calculates checksum of whole package then - set before first part of package
+         */
+        void set_checked (bool is_checked) { m_is_checked = is_checked; }
+
+    private:
+        Crc32                m_crc;
+        std::vector<uint8_t> m_package;
+        bool                 m_is_checked = true;
+    };
+
+    // ----------------------------------
+    // framing - mode byte followed by encoded package
+
+    /**
+     * @brief first byte of framed package - values differ in every bit, so mode is recognized with up to 3 damaged bits
+     */
+    enum class Framing_mode : uint8_t {
+        WHOLE_PACKAGE      = 0x0F, // the same as encode_package - one hamming code over package and checksum
+        INTERLEAVED_SECDED = 0xF0, // (72,64) code for every 8 bytes, bit interleaved - repairs one error per word (bursts)
+    };
+
+    struct Framed_package {
+        Framing_mode mode;
+        size_t       size;
+    };
+
+    /**
+     * @return std::nullopt if package_size is too big to be encoded
+     */
+    std::optional<size_t> framed_package_size (size_t package_size, Framing_mode mode);
+    /**
+     * @brief result has to be at least framed_package_size(package.size(), mode) bytes and must not overlap package
+     * @return amount of bytes written to result, std::nullopt when result is too small
+     */
+    std::optional<size_t> encode_framed_package_into (std::span<const uint8_t> package, std::span<uint8_t> result, Framing_mode mode);
+    /**
+     * @brief decodes in place - decoded package is placed at the beginning of package
+     * @return mode used by sender and size of decoded package, std::nullopt when package is damaged
+     */
+    std::optional<Framed_package> decode_framed_package_in_place (std::span<uint8_t> package);
+
+    bool encode_framed_package (std::vector<uint8_t>& package, Framing_mode mode);
+    std::optional<Framing_mode> decode_framed_package (std::vector<uint8_t>& package);
+
+    // ----------------------------------
+    // batches - one call for packages of a tick (encode_package_into / decode_package_in_place of every package)
+
+    /**
+     * @brief the same as encode_package_into for every package, results[i] belongs to packages[i]
+     *        result_sizes[i] is std::nullopt when packages[i] wasn't encoded
+     * @return amount of encoded packages
+     */
+    size_t encode_packages_batch (std::span<const std::span<const uint8_t>> packages,
+                                  std::span<const std::span<uint8_t>> results,
+                                  std::span<std::optional<size_t>> result_sizes);
+    /**
+     * @brief the same as decode_package_in_place for every package
+     *        result_sizes[i] is std::nullopt when packages[i] is damaged
+     * @return amount of decoded packages
+     */
+    size_t decode_packages_batch (std::span<const std::span<uint8_t>> packages, std::span<std::optional<size_t>> result_sizes);
 }
 
 namespace c_wrapped_custom_utils {
     extern "C" bool encode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size);
     extern "C" bool decode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size);
     extern "C" void free_c_wrapped (uint8_t* ptr_data);
-}
\ No newline at end of file
+
+    // caller buffers - result_capacity has to be at least encoded_package_size_c_wrapped(size)
+    extern "C" size_t encoded_package_size_c_wrapped    (size_t size);
+    extern "C" bool   encode_package_into_c_wrapped     (const uint8_t* ptr_data, size_t size, uint8_t* result, size_t result_capacity, size_t* result_size);
+    extern "C" bool   decode_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, size_t* result_size);
+
+    // framing - mode is value of custom_utils::Framing_mode
+    extern "C" size_t framed_package_size_c_wrapped            (size_t size, uint8_t mode);
+    extern "C" bool   encode_framed_package_into_c_wrapped     (const uint8_t* ptr_data, size_t size, uint8_t mode, uint8_t* result, size_t result_capacity, size_t* result_size);
+    extern "C" bool   decode_framed_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t* mode, size_t* result_size);
+
+    // batches - count packages, result_sizes[i] is 0 when package wasn't encoded/decoded, return amount of successful
+    extern "C" size_t encode_packages_batch_c_wrapped (const uint8_t* const* ptr_packages, const size_t* sizes, size_t count,
+                                                       uint8_t* const* results, const size_t* result_capacities, size_t* result_sizes);
+    extern "C" size_t decode_packages_batch_c_wrapped (uint8_t* const* ptr_packages, const size_t* sizes, size_t count,
+                                                       size_t* result_sizes, bool* is_decoded);
+}
+
+#endif // ERROR_REPAIRING_H
@@ -0,0 +1,148 @@
+#ifndef FIXED_PACKAGE_CODEC_H
+#define FIXED_PACKAGE_CODEC_H
+
+#include "crc32.h"
+#include "packed_bits.h"
+#include "packed_hamming.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace custom_utils {
+    // sizes of protocol messages (before encoding) that are known at compile time
+    inline constexpr size_t PACKAGE_SIZE_TYPE         = 1;             // LOGIN, BREAK_SESSION, REGISTERED_ANSWER, BAD_FORMED
+    inline constexpr size_t PACKAGE_SIZE_TYPE_ID      = 1 + 8;         // GET_OTHER, ACKNOWLEDGE
+    inline constexpr size_t PACKAGE_SIZE_TYPE_ID_DATA = 1 + 8 + 7 * 8; // MESSAGE, FINISH (x, y, dx, dy, ddx, ddy, time)
+
+    /**
+     * @brief run of data bits between two parity bits, count <= 64 (fits into one bits::read_bits)
+     */
+    struct Hamming_data_run {
+        size_t data_bit;
+        size_t code_bit;
+        size_t count;
+    };
+
+    constexpr size_t hamming_data_runs_amount (size_t data_bits) {
+        size_t amount   = 0;
+        size_t data_bit = 0;
+        for (size_t k = 1; data_bit < data_bits; ++k) {
+            size_t run = std::min((size_t(1) << k) - 1, data_bits - data_bit);
+            amount   += (run + 63) / 64;
+            data_bit += run;
+        }
+        return amount;
+    }
+
+    template <size_t DATA_BITS>
+    consteval std::array<Hamming_data_run, hamming_data_runs_amount(DATA_BITS)> make_hamming_data_runs () {
+        std::array<Hamming_data_run, hamming_data_runs_amount(DATA_BITS)> result{};
+        size_t i        = 0;
+        size_t data_bit = 0;
+
+        // data bits - runs between parity bits: (2^k, 2^(k + 1))
+        for (size_t k = 1; data_bit < DATA_BITS; ++k) {
+            size_t code_bit = (size_t(1) << k) + 1;
+            size_t run      = std::min((size_t(1) << k) - 1, DATA_BITS - data_bit);
+
+            for (size_t part = 0; part < run; part += 64) {
+                result[i++] = {.data_bit=data_bit + part, .code_bit=code_bit + part, .count=std::min<size_t>(64, run - part)};
+            }
+            data_bit += run;
+        }
+        return result;
+    }
+
+    /**
+     * @brief the same encoding as encode_package_into/decode_package_in_place,
+     *        but layout of parity bits and sizes are evaluated at compile time (codec is fully unrolled)
+     */
+    template <size_t N>
+    class Fixed_package_codec {
+    public:
+        static constexpr size_t PACKAGE_SIZE = N;
+        static constexpr size_t DATA_SIZE    = N + sizeof(uint32_t); // package + checksum
+        static constexpr size_t DATA_BITS    = DATA_SIZE * 8;
+        static constexpr size_t PARITY_BITS  = hamming_parity_bits(DATA_BITS);
+        static constexpr size_t ENCODED_SIZE = hamming_encoded_size(DATA_SIZE);
+        static_assert(hamming_decoded_size(ENCODED_SIZE) == DATA_SIZE);
+
+    public:
+        static size_t encode (std::span<const uint8_t, N> package, std::span<uint8_t, ENCODED_SIZE> result) {
+            return encode(package, crc32_update_slice_8(CRC32_INITIAL, package), result);
+        }
+
+        /**
+         * @brief checksum is crc of package - already calculated by caller (Crc32)
+         */
+        static size_t encode (std::span<const uint8_t, N> package, uint32_t checksum, std::span<uint8_t, ENCODED_SIZE> result) {
+            // part I: error check_sum (big endian after package)
+            std::array<uint64_t, DATA_WORDS> data{};
+            bits::load_words(package, data);
+            bits::or_bits(data, N * 8, checksum, 32);
+
+            // part II: repair code
+            std::array<uint64_t, CODE_WORDS> code{};
+            scatter(code, data, std::make_index_sequence<RUNS.size()>{});
+
+            bits::Syndrome syndrome = bits::calculate_syndrome(code);
+            [&]<size_t... K>(std::index_sequence<K...>) {
+                ((code[(size_t(1) << K) / 64] |= uint64_t((syndrome.position >> K) & 1) << (63 - (size_t(1) << K) % 64)), ...);
+            }(std::make_index_sequence<PARITY_BITS>{});
+
+            bool is_global_even = (syndrome.is_odd == bool(std::popcount(syndrome.position) & 1));
+            code[0] |= uint64_t(is_global_even) << 63;
+
+            bits::store_words(code, result);
+            return ENCODED_SIZE;
+        }
+
+        /**
+         * @brief decodes in place - package is placed at the beginning of code
+         * @return false when package is damaged
+         */
+        static bool decode (std::span<uint8_t, ENCODED_SIZE> code) {
+            std::array<uint64_t, CODE_WORDS> code_words{};
+            bits::load_words(code, code_words);
+
+            // part I: repair code
+            bool expect_global_even = (code[0] & 0x80) != 0;
+            bits::Syndrome syndrome = bits::calculate_syndrome(code_words);
+            bool is_global_even     = (syndrome.is_odd == expect_global_even); // global parity bit itself is not counted
+
+            if (syndrome.position != 0 and is_global_even == expect_global_even) return false;
+            if (syndrome.position > ENCODED_SIZE * 8 - 1) return false;
+            if (syndrome.position != 0 and not std::has_single_bit(syndrome.position)) {
+                bits::flip_bit(code_words, syndrome.position);
+            }
+
+            std::array<uint64_t, DATA_WORDS> data{};
+            gather(data, code_words, std::make_index_sequence<RUNS.size()>{});
+            bits::store_words(data, code.template first<DATA_SIZE>());
+
+            // part II: error check_sum - check after repairing
+            return crc32_update_slice_8(CRC32_INITIAL, code.template first<DATA_SIZE>()) == 0;
+        }
+
+    private:
+        static constexpr size_t DATA_WORDS = (DATA_SIZE + 7) / 8 + 1;
+        static constexpr size_t CODE_WORDS = (ENCODED_SIZE + 7) / 8 + 1;
+        static constexpr auto   RUNS       = make_hamming_data_runs<DATA_BITS>();
+
+        template <size_t... I>
+        static void scatter (std::array<uint64_t, CODE_WORDS>& code, const std::array<uint64_t, DATA_WORDS>& data, std::index_sequence<I...>) {
+            (bits::or_bits(code, RUNS[I].code_bit, bits::read_bits(data, RUNS[I].data_bit, RUNS[I].count), RUNS[I].count), ...);
+        }
+
+        template <size_t... I>
+        static void gather (std::array<uint64_t, DATA_WORDS>& data, const std::array<uint64_t, CODE_WORDS>& code, std::index_sequence<I...>) {
+            (bits::or_bits(data, RUNS[I].data_bit, bits::read_bits(code, RUNS[I].code_bit, RUNS[I].count), RUNS[I].count), ...);
+        }
+    };
+}
+
+#endif // FIXED_PACKAGE_CODEC_H
@@ -0,0 +1,180 @@
+#include "interleaved_secded.h"
+#include "packed_bits.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+using namespace custom_utils::bits;
+
+static constexpr size_t PARITY_BITS = 7;
+static constexpr size_t BLOCK_WORDS = 64; // words decoded at once - one bit of each word in uint64_t
+
+using Block = std::array<uint64_t, custom_utils::SECDED_CODE_BITS>; // rows of block (bit j of 64 words)
+
+// hamming position of every data bit (numbers that aren't power of two: 3, 5, 6, 7, 9, ...)
+consteval std::array<uint8_t, custom_utils::SECDED_DATA_BITS> make_data_positions () {
+    std::array<uint8_t, custom_utils::SECDED_DATA_BITS> result{};
+    uint8_t position = 3;
+    for (auto& data_position : result) {
+        while (std::has_single_bit(position)) ++position;
+        data_position = position++;
+    }
+    return result;
+}
+
+// SELECTED[k][bit] - all ones when hamming position of data bit has bit k set (branchless, so loops are vectorized)
+consteval std::array<std::array<uint64_t, custom_utils::SECDED_DATA_BITS>, PARITY_BITS> make_selected () {
+    constexpr std::array<uint8_t, custom_utils::SECDED_DATA_BITS> positions = make_data_positions();
+
+    std::array<std::array<uint64_t, custom_utils::SECDED_DATA_BITS>, PARITY_BITS> result{};
+    for (size_t k = 0; k < PARITY_BITS; ++k) {
+        for (size_t bit = 0; bit < custom_utils::SECDED_DATA_BITS; ++bit) {
+            result[k][bit] = ((positions[bit] >> k) & 1) ? ~uint64_t(0) : 0;
+        }
+    }
+    return result;
+}
+
+static constexpr auto SELECTED = make_selected();
+
+// swaps of width x width bit squares (mask - bits of square that stay in place)
+template <size_t WIDTH, uint64_t MASK>
+static void transpose_stage (std::span<uint64_t, BLOCK_WORDS> rows) {
+    for (size_t first = 0; first < BLOCK_WORDS; first += 2 * WIDTH) {
+        for (size_t k = first; k < first + WIDTH; ++k) {
+            uint64_t swap = (rows[k] ^ (rows[k + WIDTH] >> WIDTH)) & MASK;
+            rows[k]         ^= swap;
+            rows[k + WIDTH] ^= swap << WIDTH;
+        }
+    }
+}
+
+// rows[i] <-> bit i of all words (most significant bit first, 64x64 bit matrix)
+static void transpose (std::span<uint64_t, BLOCK_WORDS> rows) {
+    transpose_stage<32, 0x00000000FFFFFFFF>(rows);
+    transpose_stage<16, 0x0000FFFF0000FFFF>(rows);
+    transpose_stage<8,  0x00FF00FF00FF00FF>(rows);
+    transpose_stage<4,  0x0F0F0F0F0F0F0F0F>(rows);
+    transpose_stage<2,  0x3333333333333333>(rows);
+    transpose_stage<1,  0x5555555555555555>(rows);
+}
+
+// parity rows (without global parity) of data rows
+static std::array<uint64_t, PARITY_BITS> calculate_parity (const Block& block) {
+    std::array<uint64_t, PARITY_BITS> result{};
+    for (size_t k = 0; k < PARITY_BITS; ++k) {
+        for (size_t bit = 0; bit < custom_utils::SECDED_DATA_BITS; ++bit) result[k] ^= block[bit] & SELECTED[k][bit];
+    }
+    return result;
+}
+
+// repairs one error in every word - false when syndrome of some word isn't a position of code
+static bool repair (Block& block, const std::array<uint64_t, PARITY_BITS>& syndrome, uint64_t has_syndrome, uint64_t is_odd) {
+    // word whose syndrome is position of data bit
+    std::array<uint64_t, custom_utils::SECDED_DATA_BITS> is_position;
+    std::ranges::fill(is_position, is_odd);
+    for (size_t k = 0; k < PARITY_BITS; ++k) {
+        for (size_t bit = 0; bit < custom_utils::SECDED_DATA_BITS; ++bit) is_position[bit] &= ~(syndrome[k] ^ SELECTED[k][bit]);
+    }
+
+    uint64_t is_repaired = ~has_syndrome; // no error, or error in global parity
+    for (size_t bit = 0; bit < custom_utils::SECDED_DATA_BITS; ++bit) {
+        block[bit]  ^= is_position[bit];
+        is_repaired |= is_position[bit];
+    }
+    // errors in parity bits (powers of two) need no repair
+    for (size_t k = 0; k < PARITY_BITS; ++k) {
+        uint64_t is_parity_position = syndrome[k];
+        for (size_t other = 0; other < PARITY_BITS; ++other) {
+            if (other != k) is_parity_position &= ~syndrome[other];
+        }
+        is_repaired |= is_parity_position;
+    }
+
+    // error outside of code - more than one error
+    return ~is_repaired == 0;
+}
+
+// ---------------------------------------------------
+// encode / decode
+// ---------------------------------------------------
+
+size_t custom_utils::encode_interleaved_bytes (std::span<const uint8_t> head, std::span<const uint8_t> tail, std::span<uint8_t> result) {
+    const size_t data_size = head.size() + tail.size();
+    const size_t words     = data_size / 8;
+    const size_t code_size = interleaved_encoded_size(data_size);
+
+    Word_buffer data_buffer(words);
+    Word_buffer code_buffer((code_size + 7) / 8);
+    std::span<uint64_t> data = data_buffer.words();
+    std::span<uint64_t> code = code_buffer.words();
+    load_words(head, data);
+    load_words_at(tail, data, head.size() * 8);
+
+    for (size_t first = 0; first < words; first += BLOCK_WORDS) {
+        const size_t count = std::min(BLOCK_WORDS, words - first);
+
+        Block block{};
+        std::ranges::copy(data.subspan(first, count), block.begin());
+        transpose(std::span(block).first<BLOCK_WORDS>());
+
+        std::array<uint64_t, PARITY_BITS> parity = calculate_parity(block);
+        uint64_t global_parity = 0;
+        for (size_t bit = 0; bit < SECDED_DATA_BITS; ++bit) global_parity ^= block[bit];
+        for (size_t k = 0; k < PARITY_BITS; ++k) {
+            block[SECDED_DATA_BITS + k] = parity[k];
+            global_parity ^= parity[k];
+        }
+        block[SECDED_CODE_BITS - 1] = global_parity;
+
+        // rows are left aligned - first word is the most significant bit
+        for (size_t row = 0; row < SECDED_CODE_BITS; ++row) {
+            or_bits(code, row * words + first, block[row] >> (BLOCK_WORDS - count), count);
+        }
+    }
+
+    store_words(code, result.first(code_size));
+    return code_size;
+}
+
+std::optional<size_t> custom_utils::decode_interleaved_bytes (std::span<const uint8_t> data, std::span<uint8_t> result) {
+    if (data.size() % 9 != 0) return std::nullopt;
+
+    const size_t words = data.size() / 9;
+    const size_t size  = interleaved_decoded_size(data.size());
+
+    Word_buffer code_buffer((data.size() + 7) / 8);
+    std::span<uint64_t> code = code_buffer.words();
+    load_words(data, code); // data isn't used after - result can be the same memory
+
+    for (size_t first = 0; first < words; first += BLOCK_WORDS) {
+        const size_t count = std::min(BLOCK_WORDS, words - first);
+
+        Block block{};
+        for (size_t row = 0; row < SECDED_CODE_BITS; ++row) {
+            block[row] = read_bits(code, row * words + first, count) << (BLOCK_WORDS - count);
+        }
+
+        std::array<uint64_t, PARITY_BITS> syndrome = calculate_parity(block);
+        uint64_t has_syndrome = 0;
+        for (size_t k = 0; k < PARITY_BITS; ++k) {
+            syndrome[k]  ^= block[SECDED_DATA_BITS + k];
+            has_syndrome |= syndrome[k];
+        }
+        uint64_t is_odd = 0; // odd amount of errors
+        for (uint64_t row : block) is_odd ^= row;
+
+        // found error, but global parity is correct - more than one error
+        if ((has_syndrome & ~is_odd) != 0) return std::nullopt;
+        if ((has_syndrome | is_odd) != 0 and not repair(block, syndrome, has_syndrome, is_odd)) return std::nullopt;
+
+        transpose(std::span(block).first<BLOCK_WORDS>());
+        store_words(std::span(block).first(count), result.subspan(first * 8, count * 8));
+    }
+
+    return size;
+}
@@ -0,0 +1,48 @@
+#ifndef INTERLEAVED_SECDED_H
+#define INTERLEAVED_SECDED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+ * Data is split into 64 bit words, every word gets its own (72,64) SECDED code:
+ *     bits 0-63  - data bits of word (most significant bit of first byte first)
+ *     bits 64-70 - parity bits k (xor of data bits whose hamming position has bit k set,
+ *                  data bit b has b-th hamming position which isn't power of two, starting from 3)
+ *     bit 71     - global parity (xor of all other bits of word)
+ * Codes are bit interleaved - bit j of word i is bit (j * words + i) of the stream,
+ * so burst of up to `words` bits damages every word at most once and is repaired.
+ * Bit j of all words is one row of the stream - words are decoded 64 at once (bit sliced)
+ */
+namespace custom_utils {
+    inline constexpr size_t SECDED_DATA_BITS = 64;
+    inline constexpr size_t SECDED_CODE_BITS = 72;
+
+    /**
+     * @brief data_size has to be multiple of 8
+     */
+    constexpr size_t interleaved_encoded_size (size_t data_size) {
+        return data_size / 8 * 9;
+    }
+
+    constexpr size_t interleaved_decoded_size (size_t encoded_size) {
+        return encoded_size / 9 * 8;
+    }
+
+    /**
+     * @brief encodes head followed by tail, their size together has to be multiple of 8
+     *        result has to be at least interleaved_encoded_size(head.size() + tail.size()) bytes
+     * @return amount of bytes written to result
+     */
+    size_t encode_interleaved_bytes (std::span<const uint8_t> head, std::span<const uint8_t> tail, std::span<uint8_t> result);
+    /**
+     * @brief data.size() has to be multiple of 9, result at least interleaved_decoded_size(data.size()) bytes
+     *        result can be the same memory as data (decode in place)
+     * @return amount of bytes written to result, std::nullopt when some word can't be repaired
+     */
+    std::optional<size_t> decode_interleaved_bytes (std::span<const uint8_t> data, std::span<uint8_t> result);
+}
+
+#endif // INTERLEAVED_SECDED_H
@@ -0,0 +1,165 @@
+#ifndef PACKED_BITS_H
+#define PACKED_BITS_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+/**
+ * Big endian bit stream helpers used by hamming codecs (bit 0 = most significant bit of first byte)
+ * Stream is kept in 64 bit words - bit i is bit (63 - i % 64) of word i / 64
+ * Word arrays have to contain one additional zero word - so two words can be always read/written at any bit offset
+ */
+namespace custom_utils::bits {
+    inline void load_words (std::span<const uint8_t> bytes, std::span<uint64_t> words) {
+        size_t i = 0;
+        for (; (i + 1) * sizeof(uint64_t) <= bytes.size(); ++i) {
+            memcpy(&words[i], bytes.data() + i * sizeof(uint64_t), sizeof(uint64_t));
+            if constexpr (std::endian::native == std::endian::little) words[i] = std::byteswap(words[i]);
+        }
+
+        // last not full word
+        size_t tail = bytes.size() - i * sizeof(uint64_t);
+        if (tail == 0) return;
+        uint64_t value = 0;
+        memcpy(&value, bytes.data() + i * sizeof(uint64_t), tail);
+        if constexpr (std::endian::native == std::endian::little) value = std::byteswap(value);
+        words[i] = value;
+    }
+
+    inline void store_words (std::span<const uint64_t> words, std::span<uint8_t> bytes) {
+        size_t i = 0;
+        for (; (i + 1) * sizeof(uint64_t) <= bytes.size(); ++i) {
+            uint64_t value = words[i];
+            if constexpr (std::endian::native == std::endian::little) value = std::byteswap(value);
+            memcpy(bytes.data() + i * sizeof(uint64_t), &value, sizeof(uint64_t));
+        }
+
+        // last not full word
+        size_t tail = bytes.size() - i * sizeof(uint64_t);
+        if (tail == 0) return;
+        uint64_t value = words[i];
+        if constexpr (std::endian::native == std::endian::little) value = std::byteswap(value);
+        memcpy(bytes.data() + i * sizeof(uint64_t), &value, tail);
+    }
+
+    // count in [1, 64], result is right aligned
+    inline uint64_t read_bits (std::span<const uint64_t> words, size_t bit_offset, size_t count) {
+        size_t   shift = bit_offset % 64;
+        uint64_t value = words[bit_offset / 64] << shift;
+        if (shift != 0) value |= words[bit_offset / 64 + 1] >> (64 - shift);
+        return value >> (64 - count);
+    }
+
+    // count in [1, 64], destination bits have to be zero
+    inline void or_bits (std::span<uint64_t> words, size_t bit_offset, uint64_t value, size_t count) {
+        size_t shift = bit_offset % 64;
+        value <<= 64 - count; // left aligned
+        words[bit_offset / 64] |= value >> shift;
+        if (shift != 0) words[bit_offset / 64 + 1] |= value << (64 - shift);
+    }
+
+    inline void copy_bits (std::span<uint64_t> destination, size_t destination_bit,
+                           std::span<const uint64_t> source, size_t source_bit, size_t count) {
+        while (count != 0) {
+            size_t run = std::min<size_t>(count, 64);
+            or_bits(destination, destination_bit, read_bits(source, source_bit, run), run);
+            destination_bit += run;
+            source_bit      += run;
+            count           -= run;
+        }
+    }
+
+    // bits of stream before bit_offset are kept
+    inline void load_words_at (std::span<const uint8_t> bytes, std::span<uint64_t> words, size_t bit_offset) {
+        if (bit_offset % 64 == 0) {
+            load_words(bytes, words.subspan(bit_offset / 64));
+            return;
+        }
+
+        // 7 bytes at a time - fits into or_bits
+        for (size_t i = 0; i < bytes.size(); i += 7) {
+            size_t   count = std::min<size_t>(7, bytes.size() - i);
+            uint64_t value = 0;
+            for (size_t j = 0; j < count; ++j) value = (value << 8) | bytes[i + j];
+            or_bits(words, bit_offset + i * 8, value, count * 8);
+        }
+    }
+
+    inline void flip_bit (std::span<uint64_t> words, size_t bit_offset) {
+        words[bit_offset / 64] ^= uint64_t(1) << (63 - bit_offset % 64);
+    }
+
+    // enough for any udp datagram - bigger packages use heap
+    inline constexpr size_t STACK_WORDS = 256;
+
+    // zeroed word array with one additional zero word
+    class Word_buffer {
+    public:
+        explicit Word_buffer (size_t words) {
+            if (words + 1 <= STACK_WORDS) {
+                m_words = std::span<uint64_t>(m_stack).first(words + 1);
+            } else {
+                m_heap.resize(words + 1);
+                m_words = m_heap;
+            }
+            std::ranges::fill(m_words, 0);
+        }
+        Word_buffer (const Word_buffer& buffer) = delete;
+
+        std::span<uint64_t> words () { return m_words; }
+
+    private:
+        std::array<uint64_t, STACK_WORDS> m_stack;
+        std::vector<uint64_t>             m_heap;
+        std::span<uint64_t>               m_words;
+    };
+
+    // ---------------------------------------------------
+    // syndrome
+    // ---------------------------------------------------
+
+    // bits of word (most significant first) whose offset inside of word has bit k set
+    inline constexpr std::array<uint64_t, 6> OFFSET_MASKS = {
+        0x5555555555555555, // offset & 1
+        0x3333333333333333, // offset & 2
+        0x0F0F0F0F0F0F0F0F, // offset & 4
+        0x00FF00FF00FF00FF, // offset & 8
+        0x0000FFFF0000FFFF, // offset & 16
+        0x00000000FFFFFFFF, // offset & 32
+    };
+
+    struct Syndrome {
+        size_t position; // xor of positions of all set bits
+        bool   is_odd;   // amount of set bits is odd
+    };
+
+    // bit position in stream is used as hamming position (so position 0 - global parity - has no influence on xor)
+    inline Syndrome calculate_syndrome (std::span<const uint64_t> code) {
+        Syndrome result{.position=0, .is_odd=false};
+        uint64_t all_words = 0; // parity of (word & mask) summed over words == parity of (xor of words & mask)
+
+        for (size_t i = 0; i < code.size(); ++i) {
+            uint64_t word = code[i];
+            all_words ^= word;
+
+            // high bits of position - the same for whole word
+            if (std::popcount(word) & 1) result.position ^= i * 64;
+        }
+
+        // low 6 bits of position - position inside of word
+        for (size_t k = 0; k < OFFSET_MASKS.size(); ++k) {
+            result.position ^= static_cast<size_t>(std::popcount(all_words & OFFSET_MASKS[k]) & 1) << k;
+        }
+        result.is_odd = std::popcount(all_words) & 1;
+
+        return result;
+    }
+}
+
+#endif // PACKED_BITS_H
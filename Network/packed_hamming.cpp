@@ -0,0 +1,93 @@
+#include "packed_hamming.h"
+#include "packed_bits.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+using namespace custom_utils::bits;
+
+// ---------------------------------------------------
+// encode / decode
+// ---------------------------------------------------
+
+size_t custom_utils::encode_repair_bytes (std::span<const uint8_t> data, std::span<uint8_t> result) {
+    return encode_repair_bytes(data, {}, result);
+}
+
+size_t custom_utils::encode_repair_bytes (std::span<const uint8_t> head, std::span<const uint8_t> tail, std::span<uint8_t> result) {
+    const size_t data_size   = head.size() + tail.size();
+    const size_t data_bits   = data_size * 8;
+    const size_t parity_bits = hamming_parity_bits(data_bits);
+    const size_t code_size   = hamming_encoded_size(data_size);
+
+    Word_buffer data_buffer((data_size + 7) / 8);
+    Word_buffer code_buffer((code_size + 7) / 8);
+    std::span<uint64_t> source = data_buffer.words();
+    std::span<uint64_t> code   = code_buffer.words();
+    load_words(head, source);
+    load_words_at(tail, source, head.size() * 8);
+
+    // data bits - runs between parity bits: (2^k, 2^(k + 1))
+    size_t data_bit = 0;
+    for (size_t k = 1; data_bit < data_bits; ++k) {
+        size_t run = std::min((size_t(1) << k) - 1, data_bits - data_bit);
+        copy_bits(code, (size_t(1) << k) + 1, source, data_bit, run);
+        data_bit += run;
+    }
+
+    // parity bits
+    Syndrome syndrome = calculate_syndrome(code);
+    for (size_t k = 0; k < parity_bits; ++k) {
+        if ((syndrome.position >> k) & 1) flip_bit(code, size_t(1) << k);
+    }
+
+    // global parity
+    bool is_global_even = (syndrome.is_odd == bool(std::popcount(syndrome.position) & 1));
+    if (is_global_even) flip_bit(code, 0);
+
+    store_words(code, result.first(code_size));
+    return code_size;
+}
+
+std::optional<size_t> custom_utils::decode_repair_bytes (std::span<const uint8_t> data, std::span<uint8_t> result) {
+    if (data.empty()) return std::nullopt;
+
+    const size_t code_bits = data.size() * 8 - 1;
+    const size_t size      = hamming_decoded_size(data.size());
+    const size_t data_bits = size * 8;
+
+    Word_buffer code_buffer((data.size() + 7) / 8);
+    Word_buffer data_buffer((size + 7) / 8);
+    std::span<uint64_t> code    = code_buffer.words();
+    std::span<uint64_t> decoded = data_buffer.words();
+    load_words(data, code);
+
+    bool expect_global_even = (data[0] & 0x80) != 0;
+    Syndrome syndrome       = calculate_syndrome(code);
+    bool is_global_even     = (syndrome.is_odd == expect_global_even); // global parity bit itself is not counted
+
+    // if found error, but global parity is correct
+    if (syndrome.position != 0 and is_global_even == expect_global_even) return std::nullopt;
+    // error outside of code - more than one error
+    if (syndrome.position > code_bits) return std::nullopt;
+
+    // error repair - errors in parity bits (powers of two) need no repair
+    if (syndrome.position != 0 and not std::has_single_bit(syndrome.position)) {
+        flip_bit(code, syndrome.position);
+    }
+
+    // data bits
+    size_t data_bit = 0;
+    for (size_t k = 1; data_bit < data_bits; ++k) {
+        size_t run = std::min((size_t(1) << k) - 1, data_bits - data_bit);
+        copy_bits(decoded, data_bit, code, (size_t(1) << k) + 1, run);
+        data_bit += run;
+    }
+
+    store_words(decoded, result.first(size));
+    return size;
+}
@@ -0,0 +1,65 @@
+#ifndef PACKED_HAMMING_H
+#define PACKED_HAMMING_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+/**
+ * Word level implementation of the hamming (SECDED) code used by error_repairing
+ * Bit layout on the wire is the same as for encode_repair_data + binary_list_to_byte_array:
+ *     bit 0            - global parity (1 when amount of ones in the hamming code is even)
+ *     bit 2^k (k >= 0) - parity bit k
+ *     other bits       - data bits, in order (most significant bit of byte first)
+ *     last byte        - completed with zero bits
+ */
+namespace custom_utils {
+    /**
+     * @brief smallest r for which 2^r >= data_bits + r + 1 (the same value as amount_of_redundant_bits)
+     */
+    constexpr size_t hamming_parity_bits (size_t data_bits) {
+        size_t redundant_bits = 0;
+        while ((size_t(1) << redundant_bits) < data_bits + redundant_bits + 1) ++redundant_bits;
+        return redundant_bits;
+    }
+
+    /**
+     * @brief size in bytes of encoded data_size bytes (global parity bit + parity bits + data bits)
+     */
+    constexpr size_t hamming_encoded_size (size_t data_size) {
+        size_t bits = data_size * 8 + hamming_parity_bits(data_size * 8) + 1;
+        return (bits + 7) / 8;
+    }
+
+    /**
+     * @brief size in bytes of data that decoder will restore from encoded_size bytes
+     *        (complition bits are dropped the same way as in decode_repair_data)
+     */
+    constexpr size_t hamming_decoded_size (size_t encoded_size) {
+        if (encoded_size == 0) return 0;
+        size_t code_bits = encoded_size * 8 - 1; // without global parity
+        size_t data_bits = code_bits - static_cast<size_t>(std::bit_width(code_bits));
+        return data_bits / 8;
+    }
+
+    /**
+     * @brief result has to be at least hamming_encoded_size(data.size()) bytes
+     * @return amount of bytes written to result
+     */
+    size_t encode_repair_bytes (std::span<const uint8_t> data, std::span<uint8_t> result);
+    /**
+     * @brief encodes head followed by tail (without joining them in memory)
+     *        result has to be at least hamming_encoded_size(head.size() + tail.size()) bytes
+     */
+    size_t encode_repair_bytes (std::span<const uint8_t> head, std::span<const uint8_t> tail, std::span<uint8_t> result);
+    /**
+     * @brief result has to be at least hamming_decoded_size(data.size()) bytes
+     *        result can be the same memory as data (decode in place)
+     * @return amount of bytes written to result, std::nullopt when error can't be repaired
+     */
+    std::optional<size_t> decode_repair_bytes (std::span<const uint8_t> data, std::span<uint8_t> result);
+}
+
+#endif // PACKED_HAMMING_H
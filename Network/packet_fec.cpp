@@ -0,0 +1,391 @@
+#include "packet_fec.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+    #define FEC_HAS_SSSE3_KERNEL 1
+    #include <immintrin.h>
+#else
+    #define FEC_HAS_SSSE3_KERNEL 0
+#endif
+
+// ---------------------------------------------------
+// GF(256)
+// ---------------------------------------------------
+
+struct Gf256_tables {
+    std::array<uint8_t, 2 * 255> exp; // doubled - log(a) + log(b) needs no modulo
+    std::array<uint8_t, 256>     log;
+};
+
+consteval Gf256_tables make_gf256_tables () {
+    Gf256_tables result{};
+    uint16_t value = 1;
+    for (size_t power = 0; power < 255; ++power) {
+        result.exp[power]                  = static_cast<uint8_t>(value);
+        result.log[value]                  = static_cast<uint8_t>(power);
+        value <<= 1;
+        if (value & 0x100) value ^= 0x11D;
+    }
+    for (size_t power = 255; power < result.exp.size(); ++power) result.exp[power] = result.exp[power - 255];
+    return result;
+}
+
+static constexpr Gf256_tables GF256 = make_gf256_tables();
+
+static uint8_t gf256_multiply (uint8_t a, uint8_t b) {
+    if (a == 0 or b == 0) return 0;
+    return GF256.exp[GF256.log[a] + GF256.log[b]];
+}
+
+static uint8_t gf256_inverse (uint8_t a) {
+    return GF256.exp[255 - GF256.log[a]];
+}
+
+// coefficient of data shard in parity shard (cauchy matrix - every square submatrix is invertible)
+static uint8_t parity_coefficient (const custom_utils::Fec_config& config, size_t parity, size_t data) {
+    return gf256_inverse(static_cast<uint8_t>((config.data_shards + parity) ^ data));
+}
+
+#if FEC_HAS_SSSE3_KERNEL
+
+// 16 products at a time - products of low and high nibbles are looked up by shuffle
+__attribute__((target("ssse3")))
+static size_t multiply_add_ssse3 (uint8_t* destination, const uint8_t* source, size_t size,
+                                  const std::array<uint8_t, 16>& low, const std::array<uint8_t, 16>& high) {
+    const __m128i low_table  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(low.data()));
+    const __m128i high_table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(high.data()));
+    const __m128i nibble     = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i value   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i product = _mm_xor_si128(_mm_shuffle_epi8(low_table,  _mm_and_si128(value, nibble)),
+                                        _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi64(value, 4), nibble)));
+        __m128i result  = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(destination + i)), product);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), result);
+    }
+    return i;
+}
+
+static bool has_ssse3 () {
+    static const bool result = __builtin_cpu_supports("ssse3");
+    return result;
+}
+
+#endif
+
+void custom_utils::gf256_multiply_add (std::span<uint8_t> destination, std::span<const uint8_t> source, uint8_t coefficient) {
+    if (coefficient == 0) return;
+
+    // products of nibbles - a * (high << 4 ^ low) = a * (high << 4) ^ a * low
+    std::array<uint8_t, 16> low;
+    std::array<uint8_t, 16> high;
+    for (uint8_t i = 0; i < 16; ++i) {
+        low[i]  = gf256_multiply(coefficient, i);
+        high[i] = gf256_multiply(coefficient, static_cast<uint8_t>(i << 4));
+    }
+
+    size_t i = 0;
+#if FEC_HAS_SSSE3_KERNEL
+    if (has_ssse3()) i = multiply_add_ssse3(destination.data(), source.data(), source.size(), low, high);
+#endif
+    for (; i < source.size(); ++i) {
+        destination[i] ^= low[source[i] & 0x0F] ^ high[source[i] >> 4];
+    }
+}
+
+// ---------------------------------------------------
+// datagrams
+// ---------------------------------------------------
+
+bool custom_utils::is_valid_fec_config (const Fec_config& config) {
+    if (config.data_shards == 0 or config.parity_shards == 0) return false;
+    if (size_t(config.data_shards) + config.parity_shards > UINT8_MAX) return false;
+
+    switch (config.scheme) {
+        case Fec_scheme::XOR:          return config.parity_shards == 1;
+        case Fec_scheme::REED_SOLOMON: return true;
+    }
+    return false;
+}
+
+struct Fec_header {
+    uint16_t                 group;
+    uint8_t                  index;
+    custom_utils::Fec_config config;
+    uint16_t                 shard_size;
+};
+
+static std::vector<uint8_t> make_datagram (const Fec_header& header, std::span<const uint8_t> payload) {
+    // sized before copy - destination of payload is known to be big enough
+    std::vector<uint8_t> result(custom_utils::FEC_HEADER_SIZE + payload.size());
+    const std::array<uint8_t, custom_utils::FEC_HEADER_SIZE> bytes{
+        custom_utils::FEC_PACKAGE_TYPE,
+        uint8_t(header.group >> 8), uint8_t(header.group),
+        header.index,
+        header.config.data_shards, header.config.parity_shards, static_cast<uint8_t>(header.config.scheme),
+        uint8_t(header.shard_size >> 8), uint8_t(header.shard_size),
+    };
+    std::ranges::copy(bytes, result.begin());
+    std::ranges::copy(payload, result.begin() + custom_utils::FEC_HEADER_SIZE);
+    return result;
+}
+
+static std::optional<Fec_header> parse_header (std::span<const uint8_t> datagram) {
+    if (datagram.size() < custom_utils::FEC_HEADER_SIZE or datagram[0] != custom_utils::FEC_PACKAGE_TYPE) return std::nullopt;
+
+    Fec_header header{
+        .group      = static_cast<uint16_t>((datagram[1] << 8) | datagram[2]),
+        .index      = datagram[3],
+        .config     = {.scheme=static_cast<custom_utils::Fec_scheme>(datagram[6]), .data_shards=datagram[4], .parity_shards=datagram[5]},
+        .shard_size = static_cast<uint16_t>((datagram[7] << 8) | datagram[8]),
+    };
+    if (not custom_utils::is_valid_fec_config(header.config)) return std::nullopt;
+    if (header.index >= header.config.data_shards + header.config.parity_shards) return std::nullopt;
+
+    return header;
+}
+
+// k isn't compared - parity of flushed group has smaller one
+static bool is_same_session (const custom_utils::Fec_config& a, const custom_utils::Fec_config& b) {
+    return a.scheme == b.scheme and a.parity_shards == b.parity_shards;
+}
+
+// ---------------------------------------------------
+// encoder
+// ---------------------------------------------------
+
+custom_utils::Fec_encoder::Fec_encoder (Fec_config config) : m_config{config} {
+    m_shards.reserve(config.data_shards);
+}
+
+std::optional<std::vector<std::vector<uint8_t>>> custom_utils::Fec_encoder::push (std::span<const uint8_t> package) {
+    if (package.size() > UINT16_MAX - sizeof(uint16_t)) return std::nullopt;
+
+    const auto shard_size = static_cast<uint16_t>(package.size() + sizeof(uint16_t));
+    if (m_shards.empty()) m_group_start = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint8_t>> result;
+    result.push_back(make_datagram({.group=m_group, .index=static_cast<uint8_t>(m_shards.size()), .config=m_config, .shard_size=shard_size}, package));
+
+    std::vector<uint8_t>& shard = m_shards.emplace_back();
+    shard.reserve(shard_size);
+    shard.insert(shard.end(), {uint8_t(package.size() >> 8), uint8_t(package.size())});
+    shard.insert(shard.end(), package.begin(), package.end());
+
+    if (m_shards.size() == m_config.data_shards) finish_group(result);
+    return result;
+}
+
+std::vector<std::vector<uint8_t>> custom_utils::Fec_encoder::flush (std::chrono::steady_clock::duration timeout) {
+    std::vector<std::vector<uint8_t>> result;
+    if (m_shards.empty() or std::chrono::steady_clock::now() - m_group_start < timeout) return result;
+
+    finish_group(result);
+    return result;
+}
+
+void custom_utils::Fec_encoder::finish_group (std::vector<std::vector<uint8_t>>& result) {
+    // k of parity is amount of packages of group (less than k of session when group is flushed)
+    Fec_config config  = m_config;
+    config.data_shards = static_cast<uint8_t>(m_shards.size());
+
+    size_t parity_size = std::ranges::max(m_shards, {}, &std::vector<uint8_t>::size).size();
+    for (size_t parity = 0; parity < config.parity_shards; ++parity) {
+        std::vector<uint8_t> parity_shard(parity_size, 0);
+        for (size_t data = 0; data < m_shards.size(); ++data) {
+            if (config.scheme == Fec_scheme::XOR) {
+                for (size_t i = 0; i < m_shards[data].size(); ++i) parity_shard[i] ^= m_shards[data][i];
+            } else {
+                gf256_multiply_add(parity_shard, m_shards[data], parity_coefficient(config, parity, data));
+            }
+        }
+
+        Fec_header header{
+            .group      = m_group,
+            .index      = static_cast<uint8_t>(config.data_shards + parity),
+            .config     = config,
+            .shard_size = static_cast<uint16_t>(parity_size),
+        };
+        result.push_back(make_datagram(header, parity_shard));
+    }
+
+    m_shards.clear();
+    ++m_group;
+}
+
+// ---------------------------------------------------
+// decoder
+// ---------------------------------------------------
+
+// inverse of square matrix (gauss-jordan), matrix is destroyed
+static std::optional<std::vector<std::vector<uint8_t>>> invert (std::vector<std::vector<uint8_t>>& matrix) {
+    const size_t size = matrix.size();
+    std::vector<std::vector<uint8_t>> result(size, std::vector<uint8_t>(size, 0));
+    for (size_t i = 0; i < size; ++i) result[i][i] = 1;
+
+    for (size_t column = 0; column < size; ++column) {
+        auto pivot = std::find_if(matrix.begin() + static_cast<ptrdiff_t>(column), matrix.end(),
+                                  [column] (const std::vector<uint8_t>& row) { return row[column] != 0; });
+        if (pivot == matrix.end()) return std::nullopt;
+
+        size_t pivot_row = static_cast<size_t>(pivot - matrix.begin());
+        std::swap(matrix[column], matrix[pivot_row]);
+        std::swap(result[column], result[pivot_row]);
+
+        uint8_t inverse = gf256_inverse(matrix[column][column]);
+        for (size_t i = 0; i < size; ++i) {
+            matrix[column][i] = gf256_multiply(matrix[column][i], inverse);
+            result[column][i] = gf256_multiply(result[column][i], inverse);
+        }
+
+        for (size_t row = 0; row < size; ++row) {
+            uint8_t factor = matrix[row][column];
+            if (row == column or factor == 0) continue;
+            custom_utils::gf256_multiply_add(matrix[row], matrix[column], factor);
+            custom_utils::gf256_multiply_add(result[row], result[column], factor);
+        }
+    }
+    return result;
+}
+
+std::vector<std::vector<uint8_t>> custom_utils::Fec_decoder::push (std::span<const uint8_t> datagram) {
+    std::vector<std::vector<uint8_t>> result;
+
+    std::optional<Fec_header> header = parse_header(datagram);
+    if (not header.has_value()) return result;
+    std::span<const uint8_t> payload = datagram.subspan(FEC_HEADER_SIZE);
+
+    // group
+    auto found = m_groups.find(header->group);
+    if (found == m_groups.end()) {
+        if (m_order.size() == MAX_GROUPS) {
+            m_groups.erase(m_order.front());
+            m_order.pop_front();
+        }
+
+        Group group{};
+        group.config = header->config;
+        group.shards.resize(header->config.data_shards + header->config.parity_shards);
+        found = m_groups.emplace(header->group, std::move(group)).first;
+        m_order.push_back(header->group);
+    }
+
+    Group& group = found->second;
+    if (not is_same_session(group.config, header->config) or group.is_complete) return result;
+
+    // flushed group - its parity has k of sent packages, data datagrams have full k
+    bool is_data = header->index < header->config.data_shards;
+    if (not is_data and header->config.data_shards < group.config.data_shards and not shrink(group, header->config.data_shards)) return result;
+    if (is_data ? header->index >= group.config.data_shards : header->config.data_shards != group.config.data_shards) return result;
+
+    // k of group and of datagram are the same now (or datagram is data) - index is its place in group
+    size_t index = header->index;
+    if (not group.shards[index].empty()) return result; // repeated datagram
+
+    if (is_data) {
+        if (payload.size() > UINT16_MAX - sizeof(uint16_t)) return result;
+
+        std::vector<uint8_t>& shard = group.shards[index];
+        shard.resize(sizeof(uint16_t) + payload.size());
+        shard[0] = uint8_t(payload.size() >> 8);
+        shard[1] = uint8_t(payload.size());
+        std::ranges::copy(payload, shard.begin() + sizeof(uint16_t));
+
+        result.emplace_back(payload.begin(), payload.end());
+    } else {
+        if (payload.size() != header->shard_size or header->shard_size == 0) return result;
+        if (group.shard_size != 0 and group.shard_size != header->shard_size) return result;
+
+        group.shard_size = header->shard_size;
+        group.shards[index].assign(payload.begin(), payload.end());
+    }
+
+    restore(group, result);
+    return result;
+}
+
+bool custom_utils::Fec_decoder::shrink (Group& group, uint8_t data_shards) {
+    // data after data_shards was never sent, parity of full group can't be there
+    for (size_t i = data_shards; i < group.shards.size(); ++i) {
+        if (not group.shards[i].empty()) return false;
+    }
+
+    group.config.data_shards = data_shards;
+    group.shards.resize(size_t(data_shards) + group.config.parity_shards);
+    return true;
+}
+
+void custom_utils::Fec_decoder::restore (Group& group, std::vector<std::vector<uint8_t>>& result) {
+    const size_t data_shards = group.config.data_shards;
+
+    std::vector<size_t> missing;
+    std::vector<size_t> parity;
+    for (size_t i = 0; i < group.shards.size(); ++i) {
+        if (not group.shards[i].empty()) {
+            if (i >= data_shards) parity.push_back(i - data_shards);
+        } else if (i < data_shards) {
+            missing.push_back(i);
+        }
+    }
+
+    if (missing.empty()) {
+        group.is_complete = true;
+        group.shards      = {};
+        return;
+    }
+    if (parity.size() < missing.size()) return; // wait for more datagrams
+
+    // all data shards have size of parity
+    for (size_t data = 0; data < data_shards; ++data) {
+        if (group.shards[data].size() > group.shard_size) { // damaged group
+            group.is_complete = true;
+            group.shards      = {};
+            return;
+        }
+        if (not group.shards[data].empty()) group.shards[data].resize(group.shard_size, 0);
+    }
+
+    // remainders of parity - parity of known data is removed (only missing data is left)
+    parity.resize(missing.size());
+    std::vector<std::vector<uint8_t>> remainders;
+    for (size_t p : parity) {
+        std::vector<uint8_t> remainder = group.shards[data_shards + p];
+        for (size_t data = 0; data < data_shards; ++data) {
+            if (group.shards[data].empty()) continue;
+            uint8_t coefficient = group.config.scheme == Fec_scheme::XOR ? 1 : parity_coefficient(group.config, p, data);
+            gf256_multiply_add(remainder, group.shards[data], coefficient);
+        }
+        remainders.push_back(std::move(remainder));
+    }
+
+    // remainders = matrix * missing  =>  missing = inverse(matrix) * remainders
+    std::vector<std::vector<uint8_t>> matrix(missing.size(), std::vector<uint8_t>(missing.size()));
+    for (size_t row = 0; row < parity.size(); ++row) {
+        for (size_t column = 0; column < missing.size(); ++column) {
+            matrix[row][column] = group.config.scheme == Fec_scheme::XOR ? 1 : parity_coefficient(group.config, parity[row], missing[column]);
+        }
+    }
+    std::optional<std::vector<std::vector<uint8_t>>> inverse = invert(matrix);
+
+    if (inverse.has_value()) {
+        for (size_t i = 0; i < missing.size(); ++i) {
+            std::vector<uint8_t> shard(group.shard_size, 0);
+            for (size_t row = 0; row < remainders.size(); ++row) {
+                gf256_multiply_add(shard, remainders[row], inverse.value()[i][row]);
+            }
+
+            size_t size = (size_t(shard[0]) << 8) | shard[1];
+            if (size + sizeof(uint16_t) > shard.size()) continue; // damaged datagram in group
+            result.emplace_back(shard.begin() + sizeof(uint16_t), shard.begin() + static_cast<ptrdiff_t>(sizeof(uint16_t) + size));
+        }
+    }
+
+    group.is_complete = true;
+    group.shards      = {};
+}
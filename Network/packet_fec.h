@@ -0,0 +1,101 @@
+#ifndef PACKET_FEC_H
+#define PACKET_FEC_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+/**
+ * Erasure coding over groups of packages - k data datagrams are followed by m parity datagrams,
+ * any k datagrams of group are enough to restore all packages (lost datagrams are rebuilt without resending)
+ * Datagram (before encode_package):
+ *     byte 0    - FEC_PACKAGE_TYPE (is not used by types of Package and Answer)
+ *     bytes 1-2 - group (big endian, wraps)
+ *     byte 3    - index in group (data: [0, k), parity: [k, k + m))
+ *     byte 4    - k, byte 5 - m, byte 6 - scheme
+ *                 (parity of group flushed before k packages has amount of its packages as k, data datagrams have full k)
+ *     bytes 7-8 - shard size (big endian)
+ *     other     - data: package, parity: parity shard
+ * Shard of package is its size (2 bytes, big endian) + package, completed with zeros to size of the biggest shard of group
+ */
+namespace custom_utils {
+    inline constexpr uint8_t FEC_PACKAGE_TYPE = 0x40;
+    inline constexpr size_t  FEC_HEADER_SIZE  = 9;
+
+    enum class Fec_scheme : uint8_t {
+        XOR          = 0, // one parity datagram - xor of shards
+        REED_SOLOMON = 1, // m parity datagrams - cauchy reed solomon over GF(256)
+    };
+
+    struct Fec_config {
+        Fec_scheme scheme;
+        uint8_t    data_shards;   // k
+        uint8_t    parity_shards; // m
+    };
+
+    [[nodiscard]] bool is_valid_fec_config (const Fec_config& config);
+
+    /**
+     * @brief GF(256) (polynomial 0x11D): destination ^= coefficient * source, source isn't bigger than destination
+     */
+    void gf256_multiply_add (std::span<uint8_t> destination, std::span<const uint8_t> source, uint8_t coefficient);
+
+    class Fec_encoder {
+    public:
+        explicit Fec_encoder (Fec_config config);
+
+        /**
+         * @brief data datagram of package is returned at once, parity datagrams are added after last package of group
+         * @return std::nullopt when package is too big for shard
+         */
+        std::optional<std::vector<std::vector<uint8_t>>> push (std::span<const uint8_t> package);
+        /**
+         * @brief parity datagrams of unfinished group when its first package is older than timeout, next package starts new group
+         *        (sparse sender - last packages are protected without waiting for k of them)
+         * @return empty when there is no unfinished group (or it isn't old enough)
+         */
+        std::vector<std::vector<uint8_t>> flush (std::chrono::steady_clock::duration timeout = {});
+
+    private:
+        void finish_group (std::vector<std::vector<uint8_t>>& result); // parity of m_shards
+
+    private:
+        Fec_config                            m_config;
+        uint16_t                              m_group = 0;
+        std::vector<std::vector<uint8_t>>     m_shards; // shards of current group
+        std::chrono::steady_clock::time_point m_group_start; // first package of current group
+    };
+
+    class Fec_decoder {
+    public:
+        /**
+         * @return packages that became available - package of data datagram and packages restored by it
+         *         (every package is returned once), empty when datagram is damaged or isn't needed
+         */
+        std::vector<std::vector<uint8_t>> push (std::span<const uint8_t> datagram);
+
+    private:
+        struct Group {
+            Fec_config                        config;
+            size_t                            shard_size = 0; // known after first parity datagram
+            std::vector<std::vector<uint8_t>> shards;         // empty - not received
+            bool                              is_complete = false;
+        };
+
+        static void restore (Group& group, std::vector<std::vector<uint8_t>>& result);
+        static bool shrink  (Group& group, uint8_t data_shards); // group was flushed - false when it has shards after data_shards
+
+    private:
+        static constexpr size_t MAX_GROUPS = 8; // older groups can't be restored anymore
+
+        std::map<uint16_t, Group> m_groups;
+        std::deque<uint16_t>      m_order;
+    };
+}
+
+#endif // PACKET_FEC_H
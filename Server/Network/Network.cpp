@@ -4,113 +4,204 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <algorithm>
 #include <array>
-#include <winsock2.h>
+#include <cstring>
 #include <syncstream>
-#include <ws2ipdef.h>
+#include <thread>
 #include <error_repairing.h>
 
 using std::to_string;
 
-Network::Network() {
-    WSADATA wsaData;
-    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        std::osyncstream(std::cerr) << "Socket startup failed: " << WSAGetLastError() << '\n';
-        exit(1);
+Network::Network (Network_config config): m_config(config) {
+    if (m_config.io_batch == 0) m_config.io_batch = 1;
+    if (m_config.receive_shards == 0) m_config.receive_shards = 1;
+    if (m_config.packet_buffers == 0) m_config.packet_buffers = 1;
+    if (m_config.receive_shards > 1 and not Udp_socket::supports_reuse_port()) {
+        std::osyncstream(std::cerr) << "Sharded receive isn't supported by platform, one socket is used" << '\n';
+        m_config.receive_shards = 1;
     }
+
+    // decoded queue of worker holds as many messages as one shard has buffers
+    for (size_t i = 0; i < m_config.decode_workers; ++i) {
+        m_workers.push_back(std::make_unique<Decode_worker>(m_config.packet_buffers));
+    }
+
+    m_shards.reserve(m_config.receive_shards);
+    for (size_t i = 0; i < m_config.receive_shards; ++i) {
+        m_shards.push_back(std::make_unique<Receive_shard>(m_config.packet_buffers, std::max(m_workers.size(), size_t(1))));
+    }
+
+    if (not Udp_socket::startup()) exit(1);
     std::osyncstream(std::cout) << "Socket startup success" << '\n';
 }
 
 Network::~Network () {
-    if (WSACleanup() != 0) {
-        std::osyncstream(std::cerr) << "Socket shutdown failed: " << WSAGetLastError() << '\n';
-        exit(1);
-    }
+    if (not Udp_socket::cleanup()) exit(1);
     std::osyncstream(std::cout) << "Socket shutdown success" << '\n';
 }
 
-bool Network::setup_socket () {
-    // get server info
-    addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family   = AF_INET;     // AF_INET or AF_INET6 (IPv4 or IPv6)
-    hints.ai_socktype = SOCK_DGRAM;  // UDP
-    hints.ai_protocol = 0;           // use default protocol implementation for UDP
-    hints.ai_flags    = AI_PASSIVE;  // used resolution for socket creation and binding
-    addrinfo* result;
-    int error = getaddrinfo(nullptr, "20123", &hints, &result);
-    if (error != 0) {
-        std::osyncstream(std::cerr) << "Self address resolution failed: " << gai_strerror(error) << '\n';
-        return false;
-    }
-
-    // UDP socket
-    m_server_socket = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
-    if (m_server_socket == INVALID_SOCKET) {
-        std::osyncstream(std::cerr) << "Socket creation failed: " << WSAGetLastError() << '\n';
-        freeaddrinfo(result);
-        closesocket(m_server_socket);
-        return false;
-    }
-
-    // set socket options
-    int opt = 1;
-    if (setsockopt(m_server_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) == SOCKET_ERROR) {
-        std::osyncstream(std::cerr) << "Socket modification failed: " << WSAGetLastError() << '\n';
-        freeaddrinfo(result);
-        closesocket(m_server_socket);
-        return false;
-    }
-
-    // binding
-    error = bind(m_server_socket, result->ai_addr, int(result->ai_addrlen));
-    freeaddrinfo(result); // freeing memory - unneaded after binding
-    if (error == SOCKET_ERROR) {
-        std::osyncstream(std::cerr) << "Socket binding failed: " << WSAGetLastError() << '\n';
-        closesocket(m_server_socket);
-        return false;
-    }
+size_t Network::receive_shards () const {
+    return m_shards.size();
+}
 
-    return true;
+size_t Network::decode_workers () const {
+    return m_workers.size();
 }
 
-void Network::process_error (const SOCKADDR_IN& client_address) {
-    int wsa_error = WSAGetLastError();
+bool Network::setup_socket (size_t shard) {
+    return m_shards[shard]->socket.open(SERVER_PORT, m_shards.size() > 1, m_config.backend);
+}
 
+void Network::process_error (Socket_error error, Endpoint client) {
     // this seems to be get when client is disconnects - in connection less protocol ;(
-    if (wsa_error == 10054) return; // FIXME try to find a const
+    if (error == Socket_error::CONNECTION_RESET) return;
 
-    std::osyncstream(std::cerr) << "Socket receive failed: " << wsa_error << '\n' << '\n';
-    response_bad_formed(inet_ntoa(client_address.sin_addr), std::to_string(client_address.sin_port));
+    response_bad_formed(client);
 }
 
-void Network::socket_main () {
+void Network::socket_main (size_t shard) {
     // setup
-    if (not setup_socket()) return;
+    if (shard >= m_shards.size() or not setup_socket(shard)) return;
+    Udp_socket&  socket = m_shards[shard]->socket;
+    Packet_pool& pool   = m_shards[shard]->packets;
+    std::vector<std::unique_ptr<Packet_ring>>& queues = m_shards[shard]->messages;
+    Packet_ring& ring   = *queues.front(); // counters of backpressure
+
+    // datagrams are received straight into buffers of pool, dropped ones - into one scratch buffer
+    std::vector<Received_datagram> datagrams(m_config.io_batch);
+    std::vector<uint32_t>          ids(m_config.io_batch);
+    std::vector<uint8_t>           scratch(Packet_buffer::CAPACITY);
+    std::vector<uint8_t>           is_queue_pushed(queues.size());
+    std::optional<std::chrono::steady_clock::time_point> full_since;
+
+    while (server_running) {
+        // wait for datagrams (with timeout - to see stop of server), then receive all of them
+        if (not socket.wait(RECEIVE_TIMEOUT)) continue;
+
+        while (server_running) {
+            // backpressure - without free buffer datagrams aren't received, they wait in socket (in kernel),
+            // when reader doesn't release buffers for MAX_BACKPRESSURE old datagrams are dropped
+            // (every queue has slot for every buffer - it is never full itself)
+            size_t allocated   = pool.allocate(ids);
+            bool   is_dropping = false;
+            if (allocated == 0) {
+                auto now = std::chrono::steady_clock::now();
+                if (not full_since.has_value()) {
+                    full_since = now;
+                    ring.count_full();
+                }
+                if (now - full_since.value() < MAX_BACKPRESSURE) {
+                    std::this_thread::sleep_for(FULL_QUEUE_SLEEP);
+                    continue;
+                }
+                is_dropping = true;
+            } else {
+                full_since.reset();
+            }
+
+            std::span<Received_datagram> batch = std::span(datagrams).first(is_dropping ? datagrams.size() : allocated);
+            for (size_t i = 0; i < batch.size(); ++i) {
+                batch[i].buffer = is_dropping ? std::span(scratch) : std::span(pool.buffer(ids[i]).data);
+            }
+
+            Socket_error error;
+            size_t amount = (m_config.io_batch == 1)
+                ? receive_one(socket, batch[0], error)
+                : socket.receive_batch(batch, error);
+
+            // not used buffers are back in pool
+            for (size_t i = amount; i < allocated; ++i) pool.unallocate(ids[i]);
+
+            if (error == Socket_error::WOULD_BLOCK) break;
+
+            if (amount == 0) {
+                process_error(error, Endpoint(batch[0].from));
+                continue;
+            }
+
+            if (is_dropping) {
+                ring.count_dropped(amount);
+            } else {
+                for (size_t i = 0; i < amount; ++i) {
+                    Packet_buffer& packet = pool.buffer(ids[i]);
+                    packet.from = batch[i].from;
+                    packet.size = std::min(batch[i].size, Packet_buffer::CAPACITY);
+                    // io_uring - datagram is in buffer of provided ring (after recvmsg header and address), it is copied once -
+                    // buffers of ring go back to kernel by next receive_batch, packets are held by reader for longer
+                    if (batch[i].buffer.data() != packet.data.data()) std::copy_n(batch[i].buffer.begin(), packet.size, packet.data.begin());
+                }
+                // reference of allocate goes to consumer of queue
+                if (queues.size() == 1) {
+                    ring.push(std::span(ids).first(amount));
+                    queue_signal(0).notify();
+                } else {
+                    for (size_t i = 0; i < amount; ++i) {
+                        size_t queue = decode_queue(Endpoint(pool.buffer(ids[i]).from));
+                        queues[queue]->push(std::span(ids).subspan(i, 1));
+                        is_queue_pushed[queue] = true;
+                    }
+                    for (size_t queue = 0; queue < queues.size(); ++queue) {
+                        if (not is_queue_pushed[queue]) continue;
+                        is_queue_pushed[queue] = false;
+                        queue_signal(queue).notify();
+                    }
+                }
+            }
+
+            // batch wasn't full - socket is empty, next receive would only return WOULD_BLOCK
+            if (m_config.io_batch != 1 and amount < batch.size()) break;
+        }
+    }
+
+    // cleaning
+    socket.close();
+}
+
+size_t Network::decode_queue (Endpoint client) const {
+    if (m_workers.size() <= 1) return 0;
 
-    // get data cycle
-    SOCKADDR_IN client_address;
-    int client_address_size = sizeof(client_address);
-    std::array<char, 1024> buffer;
-    int buffer_size = static_cast<int>(buffer.size());
+    // fibonacci hash of endpoint - clients are spread over workers
+    return size_t(((client.value() * 0x9E3779B97F4A7C15ull) >> 32) % m_workers.size());
+}
+
+Ring_signal& Network::queue_signal (size_t queue) {
+    return m_workers.empty() ? m_message_signal : m_workers[queue]->packet_signal;
+}
+
+void Network::decode_main (size_t worker) {
+    if (worker >= m_workers.size()) return;
+    Decode_worker& self       = *m_workers[worker];
+    size_t         next_shard = 0;
 
     while (server_running) {
-        memset(&client_address, 0, sizeof(client_address));
-        int data_size = recvfrom(m_server_socket, buffer.data(), buffer_size, 0, (SOCKADDR*)&client_address, &client_address_size);
-        client_address.sin_port = htons(client_address.sin_port);
+        // backpressure - reader is behind, packets wait in queues of shards (receive threads stop when pool is empty)
+        if (self.decoded.free_slots() == 0) {
+            std::this_thread::sleep_for(FULL_QUEUE_SLEEP);
+            continue;
+        }
 
-        if (data_size == SOCKET_ERROR) {
-            process_error(client_address);
+        Packet_handle packet = next_packet(worker, next_shard);
+        if (not packet) {
+            self.packet_signal.wait([this, worker] { return has_packet(worker) or not server_running; });
             continue;
         }
 
-        push_message(inet_ntoa(client_address.sin_addr),
-                     to_string(client_address.sin_port),
-                     std::vector<uint8_t>(buffer.data(), buffer.data() + static_cast<size_t>(data_size)));
+        std::optional<Decoded_message> decoded = decode_packet(packet);
+        packet.reset(); // buffer is free before reader takes message
+        if (not decoded.has_value()) continue;
+
+        self.decoded.push(std::move(decoded.value()));
+        m_message_signal.notify();
     }
+}
 
-    // cleaning
-    closesocket(m_server_socket);
+size_t Network::receive_one (Udp_socket& socket, Received_datagram& datagram, Socket_error& error) {
+    std::optional<size_t> size = socket.receive(datagram.buffer, datagram.from, error);
+    if (not size.has_value()) return 0;
+
+    datagram.size = size.value();
+    return 1;
 }
 
 
@@ -125,115 +216,228 @@ bool Network::is_server_running() const {
 void Network::stop_server () {
     if (not server_running) return;
     server_running = false;
+
+    m_message_signal.notify_all();
+    for (std::unique_ptr<Decode_worker>& worker : m_workers) worker->packet_signal.notify_all();
 }
 
 
 bool Network::has_message() {
-    return not messages.empty();
+    if (not m_restored_messages.empty()) return true;
+    if (m_workers.empty()) return has_packet(0);
+    return std::ranges::any_of(m_workers, [](const std::unique_ptr<Decode_worker>& worker) { return not worker->decoded.empty(); });
+}
+
+bool Network::wait_message () {
+    while (server_running) {
+        if (has_message()) return true;
+        if (m_has_outgoing) return true; // answers of decode workers - reader flushes them
+        m_message_signal.wait([this] { return has_message() or m_has_outgoing or not server_running; });
+    }
+    return has_message();
 }
 
-bool Network::decode_message (std::vector<uint8_t>& message) {
-    return custom_utils::decode_package(message);
+bool Network::has_packet (size_t queue) const {
+    return std::ranges::any_of(m_shards, [queue](const std::unique_ptr<Receive_shard>& shard) { return not shard->messages[queue]->empty(); });
+}
+
+std::optional<size_t> Network::decode_message (std::span<uint8_t> message) {
+    return custom_utils::decode_package_in_place(message);
+}
+
+bool Network::restore_message (Raw_message& raw_message) {
+    if (raw_message.package.empty() or raw_message.package[0] != custom_utils::FEC_PACKAGE_TYPE) return true;
+
+    auto fec_decoder = m_fec_decoders.find(raw_message.endpoint);
+    if (fec_decoder == m_fec_decoders.end()) return false; // no fec session - stray or spoofed source
+
+    std::vector<std::vector<uint8_t>> packages = fec_decoder->second.push(raw_message.package);
+    if (packages.empty()) return false;
+
+    // first package is returned now, others - by next pop_message
+    for (size_t i = 1; i < packages.size(); ++i) {
+        m_restored_messages.emplace_back(std::move(packages[i]), raw_message.endpoint);
+    }
+    raw_message.package = std::move(packages[0]);
+    return true;
 }
 
 std::optional<Network_package> Network::pop_message () {
-    std::unique_lock<std::mutex> lock(mutex_messages); // use message queue
+    if (not m_restored_messages.empty()) { // already decoded
+        Raw_message raw_message = std::move(m_restored_messages.front());
+        m_restored_messages.pop_front();
+        return parse_raw_message(raw_message);
+    }
 
-    cv_has_message.wait(lock, [this] { return not messages.empty() or not server_running; });
-    if (messages.empty()) { // server was stopped
+    if (not wait_message()) { // server was stopped
         std::osyncstream(std::cout) << "Attempt to pop message from empty queue when server was stopped" << '\n';
         return std::nullopt;
     }
+    if (not has_message()) return std::nullopt; // only answers wait for flush
+
+    std::optional<Decoded_message> decoded = m_workers.empty() ? decode_packet(next_packet(0, m_next_shard)) : next_decoded();
+    if (not decoded.has_value()) return std::nullopt;
+    if (decoded->fec.empty()) return std::move(decoded->package);
 
-    Raw_message raw_message = messages.front();
-    messages.pop_front();
+    // fec datagram - package can be restored later (fec decoder keeps own copy of shards)
+    Raw_message raw_message{.package=std::move(decoded->fec), .endpoint=decoded->package.endpoint};
+    if (not restore_message(raw_message)) return std::nullopt;
+    return parse_raw_message(raw_message);
+}
 
-    // decode
-    bool was_decoded = decode_message(raw_message.package);
-    if (not was_decoded) {
+std::optional<Decoded_message> Network::decode_packet (const Packet_handle& packet) {
+    Decoded_message decoded;
+    decoded.package.endpoint = Endpoint(packet->from);
+
+    // decode in place
+    std::optional<size_t> size = decode_message(packet->payload());
+    if (not size.has_value()) {
         // change to error
-        response_bad_formed(raw_message.ip, raw_message.port);
+        response_bad_formed(decoded.package.endpoint);
         return std::nullopt;
     }
+    std::span<const uint8_t> message = packet->payload().first(size.value());
+
+    if (not message.empty() and message[0] == custom_utils::FEC_PACKAGE_TYPE) {
+        decoded.fec.assign(message.begin(), message.end());
+        return decoded;
+    }
 
     // parse
+    std::optional<Package> package = parse_message(message);
+    if (not package.has_value()) {
+        // change to error
+        response_bad_formed(decoded.package.endpoint);
+        return std::nullopt;
+    }
+    decoded.package.package = package.value();
+    return decoded;
+}
+
+std::optional<Network_package> Network::parse_raw_message (Raw_message& raw_message) {
     std::optional<Package> package = parse_message(raw_message.package);
     if (not package.has_value()) {
         // change to error
-        response_bad_formed(raw_message.ip, raw_message.port);
+        response_bad_formed(raw_message.endpoint);
         return std::nullopt;
-    };
+    }
+    return Network_package{.package=package.value(), .endpoint=raw_message.endpoint};
+}
+
+Packet_handle Network::next_packet (size_t queue, size_t& next_shard) {
+    // shards in turn - one busy shard doesn't starve others
+    for (size_t i = 0; i < m_shards.size(); ++i) {
+        Receive_shard& shard = *m_shards[next_shard];
+        next_shard = (next_shard + 1) % m_shards.size();
+
+        Packet_ring&    messages = *shard.messages[queue];
+        const uint32_t* id       = messages.front();
+        if (id == nullptr) continue;
 
-    return Network_package{.package=package.value(), .ip=std::move(raw_message.ip), .port=std::move(raw_message.port)};
+        Packet_handle packet = Packet_handle::adopt(shard.packets, *id); // reference of queue
+        messages.pop();
+        return packet;
+    }
+    return {};
 }
 
-// TODO: make atomic dequeue
-void Network::push_message (std::string&& client, std::string&& port, std::vector<uint8_t>&& message) {
-    std::lock_guard<std::mutex> lock(mutex_messages);
-    messages.emplace_back(std::move(message), std::move(client), std::move(port));
-    cv_has_message.notify_one();
-    return;
+std::optional<Decoded_message> Network::next_decoded () {
+    for (size_t i = 0; i < m_workers.size(); ++i) {
+        Decode_worker& worker = *m_workers[m_next_worker];
+        m_next_worker = (m_next_worker + 1) % m_workers.size();
+
+        Decoded_message* decoded = worker.decoded.front();
+        if (decoded == nullptr) continue;
+
+        Decoded_message message = std::move(*decoded);
+        worker.decoded.pop();
+        return message;
+    }
+    return std::nullopt;
 }
 
 // ===================================
 // end of thread-made functions
 // ===================================
 
-void Network::registered_acknowledge  (const std::string& ip, const std::string& port) {
+void Network::registered_acknowledge  (Endpoint client, bool is_compact, bool is_pushing) {
     Answer answer;
-    answer.type     = Answer::Type::REGISTERED_ANSWER;
-    answer.finish   = std::nullopt;
-    answer.other    = std::nullopt;
-    answer.id       = std::nullopt;
-
-    send_answer(ip, port, answer);
+    answer.type       = Answer::Type::REGISTERED_ANSWER;
+    answer.finish     = std::nullopt;
+    answer.other      = std::nullopt;
+    answer.id         = std::nullopt;
+    answer.is_compact = is_compact;
+    answer.is_pushing = is_pushing;
+
+    send_answer(client, answer);
 }
 
-void Network::acknowledge (const std::string& ip,  const std::string& port, uint64_t id) {
+void Network::acknowledge (Endpoint client, uint64_t id) {
     Answer answer;
     answer.type     = Answer::Type::ACKNOWLEDGE;
     answer.finish   = std::nullopt;
     answer.other    = std::nullopt;
     answer.id       = id;
 
-    send_answer(ip, port, answer);
+    send_answer(client, answer);
+}
+
+void Network::acknowledge (Endpoint client, std::span<const uint64_t> ids) {
+    constexpr size_t ANSWER_SIZE = sizeof(uint8_t) + sizeof(uint64_t);
+
+    // answers (type, id) are encoded one by one into the same buffer and sent on their own
+    std::array<uint8_t, ANSWER_SIZE> answer{static_cast<uint8_t>(Answer::Type::ACKNOWLEDGE)};
+    std::vector<uint8_t>             encoded(custom_utils::encoded_package_size(ANSWER_SIZE).value());
+    for (uint64_t id : ids) {
+        uint64_t value = ntohll(id);
+        memcpy(answer.data() + sizeof(uint8_t), &value, sizeof(value));
+
+        std::optional<size_t> size = custom_utils::encode_package_into(answer, encoded);
+        if (not size.has_value()) {
+            response_bad_formed(client);
+            continue;
+        }
+        send_encoded(client, std::span(encoded).first(size.value()));
+    }
 }
 
-void Network::response_bad_formed (const std::string& ip, const std::string& port) {
+void Network::response_bad_formed (Endpoint client) {
     Answer answer;
     answer.type     = Answer::Type::BAD_FORMED;
     answer.finish   = std::nullopt;
     answer.other    = std::nullopt;
     answer.id       = std::nullopt;
-    send_answer(ip, port, answer);
+    send_answer(client, answer);
 }
 
-void Network::deleted_acknowledge (const std::string& ip, const std::string& port) {
+void Network::deleted_acknowledge (Endpoint client) {
     Answer answer;
     answer.type     = Answer::Type::BREAK_SESSION;
     answer.finish   = std::nullopt;
     answer.other    = std::nullopt;
     answer.id       = std::nullopt;
-    send_answer(ip, port, answer);
+    send_answer(client, answer);
 }
 
-void Network::send_info_of_other (const std::string& ip, const std::string& port, uint64_t id, const std::vector<Answer::Other>& other) {
-    Answer answer;
-    answer.type     = Answer::Type::OTHER;
-    answer.finish   = std::nullopt;
-    answer.other    = other;
-    answer.id       = id;
+void Network::enable_fec (Endpoint client, custom_utils::Fec_config config) {
+    m_fec_encoders.insert_or_assign(client, custom_utils::Fec_encoder(config));
+    m_fec_decoders.insert_or_assign(client, custom_utils::Fec_decoder()); // new session - groups of previous one can't be restored
+}
 
-    if (other.empty()) answer.other = std::nullopt;
+void Network::disable_fec (Endpoint client) {
+    m_fec_encoders.erase(client);
+    m_fec_decoders.erase(client);
+}
 
-    for (const auto& x : other) {
-        std::osyncstream(std::cout) << "Sending info of other: " << x.id << '\n';
-    }
+void Network::enable_compact (Endpoint client, custom_utils::Compact_config config) {
+    m_compact_configs.insert_or_assign(client, config);
+}
 
-    send_answer(ip, port, answer);
+void Network::disable_compact (Endpoint client) {
+    m_compact_configs.erase(client);
 }
 
-std::optional<Package> Network::parse_message (const std::vector<uint8_t>& message) {
+std::optional<Package> Network::parse_message (std::span<const uint8_t> message) {
     // Ensure that the message size is exactly what we expect - must be less than max amount of data
     if (message.size() > sizeof(uint8_t) + 2 * sizeof(uint64_t) + 6 * sizeof(double) or message.size() == 0) {
         return std::nullopt;
@@ -252,6 +456,35 @@ std::optional<Package> Network::parse_message (const std::vector<uint8_t>& messa
     }
     data_disposition += sizeof(uint8_t);
 
+    // 1.1 Fec config of login (optional: scheme, k, m - 1 byte each)
+    constexpr size_t FEC_CONFIG_SIZE = 3 * sizeof(uint8_t);
+    size_t           login_options   = message.size() - data_disposition;
+    if (package.type == Package::Type::LOGIN and (login_options == FEC_CONFIG_SIZE or login_options == FEC_CONFIG_SIZE + custom_utils::COMPACT_CONFIG_SIZE)) {
+        custom_utils::Fec_config fec{.scheme=static_cast<custom_utils::Fec_scheme>(data[1]), .data_shards=data[2], .parity_shards=data[3]};
+        if (not custom_utils::is_valid_fec_config(fec)) return std::nullopt;
+        package.fec = fec;
+        data_disposition += FEC_CONFIG_SIZE;
+    }
+
+    // 1.2 Compact config of login (optional: map width, map height - 2 bytes each, session start - 8 bytes)
+    if (package.type == Package::Type::LOGIN and message.size() - data_disposition == custom_utils::COMPACT_CONFIG_SIZE) {
+        package.compact = custom_utils::read_compact_config(message.subspan(data_disposition));
+        if (not package.compact.has_value()) return std::nullopt;
+    }
+
+    // 1.3 Compact message (id - varint, quantized state)
+    if (package.type == Package::Type::COMPACT_MESSAGE) {
+        std::optional<uint64_t> id = custom_utils::read_varint(message, data_disposition);
+        if (not id.has_value()) return std::nullopt;
+        package.id = id.value();
+
+        custom_utils::Compact_state state;
+        if (not custom_utils::read_compact_state(message, data_disposition, custom_utils::COMPACT_ALL_FIELDS, state)) return std::nullopt;
+        if (data_disposition != message.size()) return std::nullopt;
+        package.compact_state = state;
+        return package;
+    }
+
     // End types - types without additional payload
     bool is_type_only_package = (
         (package.type == Package::Type::BREAK_SESSION) or
@@ -267,7 +500,7 @@ std::optional<Package> Network::parse_message (const std::vector<uint8_t>& messa
     data_disposition += sizeof(uint64_t);
 
     // Id package - packages with type and id
-    if (package.type == Package::Type::GET_OTHER) return package;
+    if (package.type == Package::Type::GET_OTHER or package.type == Package::Type::ACK_SNAPSHOT) return package;
 
     // [3, 9]
     if (data_disposition + 6 * sizeof(double) + sizeof(uint64_t) != message.size()) return std::nullopt; // no correct amount of data
@@ -304,7 +537,7 @@ std::optional<Package> Network::parse_message (const std::vector<uint8_t>& messa
 
     // 9. timestamp (8 bytes, unsigned long long in network order)
     memcpy(&llong_value, data + data_disposition, sizeof(llong_value));
-    package.time = static_cast<unsigned long>(ntohll(llong_value));
+    package.time = static_cast<unsigned long long>(ntohll(llong_value));
     // Unneaded: data_disposition += sizeof(uint64_t);
 
     return package;
@@ -314,87 +547,364 @@ bool Network::encode_message (std::vector<uint8_t>& message) {
     return custom_utils::encode_package(message);
 }
 
-void Network::serialize_answer (const Answer& answer, std::vector<uint8_t>& buffer) {
+// field of answer in network byte order
+template <typename T>
+static void write_value (custom_utils::Packet_encoder& encoder, const T& value) {
+    encoder.update({reinterpret_cast<const uint8_t*>(&value), sizeof(value)});
+}
+
+// entry of OTHER answer - id, state, time (doubles are sent as their bits)
+static void serialize_other (const Answer::Other& other, std::span<uint8_t, World_snapshot::ENTRY_SIZE> entry) {
+    const std::array<uint64_t, 8> values{
+        ntohll(other.id),
+        ntohll(std::bit_cast<uint64_t>(other.x)),
+        ntohll(std::bit_cast<uint64_t>(other.y)),
+        ntohll(std::bit_cast<uint64_t>(other.dx)),
+        ntohll(std::bit_cast<uint64_t>(other.dy)),
+        ntohll(std::bit_cast<uint64_t>(other.ddx)),
+        ntohll(std::bit_cast<uint64_t>(other.ddy)),
+        ntohll(other.time),
+    };
+    memcpy(entry.data(), values.data(), entry.size());
+}
+
+void Network::serialize_answer (const Answer& answer, custom_utils::Packet_encoder& encoder) {
     uint8_t type = *reinterpret_cast<const uint8_t*>(&answer.type);
-    buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&type), reinterpret_cast<uint8_t*>(&type) + sizeof(type));
+    write_value(encoder, type);
 
 
     if (answer.id.has_value()) {
-        uint64_t id = ntohll(answer.id.value());
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&id), reinterpret_cast<uint8_t*>(&id) + sizeof(id));
+        write_value(encoder, ntohll(answer.id.value()));
     }
     if (answer.finish.has_value()) {
         uint8_t finish = answer.finish->has_finished;
-        buffer.push_back(finish);
-
-        uint64_t x = ntohll(answer.finish->x);
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&x), reinterpret_cast<uint8_t*>(&x) + sizeof(x));
+        write_value(encoder, finish);
 
-        uint64_t y = ntohll(answer.finish->y);
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&y), reinterpret_cast<uint8_t*>(&y) + sizeof(y));
-
-        uint64_t time = ntohll(answer.finish->time);
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&time), reinterpret_cast<uint8_t*>(&time) + sizeof(time));
+        write_value(encoder, ntohll(answer.finish->x));
+        write_value(encoder, ntohll(answer.finish->y));
+        write_value(encoder, ntohll(answer.finish->time));
     }
     if (answer.other.has_value()) {
-        uint64_t size = ntohll(answer.other.value().size());
-        buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&size), reinterpret_cast<uint8_t*>(&size) + sizeof(size));
+        write_value(encoder, ntohll(answer.other.value().size()));
 
+        std::array<uint8_t, World_snapshot::ENTRY_SIZE> entry;
         for (const auto& other : answer.other.value()) {
-            uint64_t value = ntohll(other.id);
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.x));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.y));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.dx));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.dy));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.ddx));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.ddy));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
-
-            value = ntohll(*reinterpret_cast<const unsigned long long*>(&other.time));
-            buffer.insert(buffer.end(), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<uint8_t*>(&value) + sizeof(value));
+            serialize_other(other, entry);
+            encoder.update(entry);
         }
     }
+    if (answer.is_compact or answer.is_pushing) {
+        // flags of session: 1 - compact state, 2 - pushed snapshots
+        uint8_t flags = uint8_t(answer.is_compact ? 1 : 0) | uint8_t(answer.is_pushing ? 2 : 0);
+        write_value(encoder, flags);
+    }
     // TODO: add check on size of array
 }
 
-void Network::send_answer (const std::string& ip, const std::string& port, const Answer& answer) {
-    // prepare data
+void Network::send_answer (Endpoint client, const Answer& answer) {
+    // prepare data - checksum is calculated while answer is serialized
+    custom_utils::Packet_encoder encoder;
+    serialize_answer(answer, encoder);
+
     std::vector<uint8_t> buffer;
+    if (not encoder.finish(buffer)) {
+        response_bad_formed(client);
+        return;
+    }
+    send_encoded(client, buffer);
+}
 
+// changed fields of players against baseline: [id][mask][fields of mask] - bit of every field after id, mask 0 - player left
+static uint64_t serialize_delta (const World_snapshot& snapshot, const World_snapshot& baseline, const Snapshot_interest& interest, std::vector<uint8_t>& delta) {
+    constexpr size_t FIELD_SIZE = sizeof(uint64_t);
+    constexpr size_t FIELDS     = World_snapshot::ENTRY_SIZE / FIELD_SIZE - 1;
+
+    delta.clear();
+    uint64_t count = 0;
+    for (const Snapshot_interest::Entry& selected : interest.entries) {
+        std::span<const uint8_t> entry = snapshot.entries(selected.entry, selected.entry + 1);
+
+        uint8_t mask = 0;
+        for (size_t field = 0; field < FIELDS; ++field) {
+            size_t offset = FIELD_SIZE * (field + 1);
+            if (selected.baseline == Snapshot_interest::NO_BASELINE or
+                memcmp(entry.data() + offset, baseline.entries(selected.baseline, selected.baseline + 1).data() + offset, FIELD_SIZE) != 0) {
+                mask |= uint8_t(1u << field);
+            }
+        }
+        if (mask == 0) continue; // player didn't change
+
+        delta.insert(delta.end(), entry.begin(), entry.begin() + FIELD_SIZE);
+        delta.push_back(mask);
+        for (size_t field = 0; field < FIELDS; ++field) {
+            if (not (mask & (1u << field))) continue;
+            size_t offset = FIELD_SIZE * (field + 1);
+            delta.insert(delta.end(), entry.begin() + offset, entry.begin() + offset + FIELD_SIZE);
+        }
+        ++count;
+    }
 
-    serialize_answer(answer, buffer);
-    if (not encode_message(buffer)) {
-        response_bad_formed(ip, port);
+    for (uint64_t player : interest.left) {
+        uint64_t id = ntohll(player);
+        delta.insert(delta.end(), reinterpret_cast<const uint8_t*>(&id), reinterpret_cast<const uint8_t*>(&id) + sizeof(id));
+        delta.push_back(0);
+        ++count;
+    }
+    return count;
+}
+
+// entries of compact answer - states are quantized for map and session start of client, so they can't be shared
+// [id - varint][state] or, with baseline, [id - varint][mask][fields of mask] (changes of quantized state only)
+static uint64_t serialize_compact (const World_snapshot& snapshot, const World_snapshot* baseline, const Snapshot_interest& interest,
+                                   const custom_utils::Compact_config& config, std::vector<uint8_t>& result) {
+    result.clear();
+    uint64_t count = 0;
+    for (const Snapshot_interest::Entry& selected : interest.entries) {
+        custom_utils::Compact_state state  = custom_utils::quantize_state(config, snapshot.other(selected.entry));
+        uint8_t                     fields = custom_utils::COMPACT_ALL_FIELDS;
+        if (baseline != nullptr and selected.baseline != Snapshot_interest::NO_BASELINE) {
+            fields = custom_utils::changed_fields(custom_utils::quantize_state(config, baseline->other(selected.baseline)), state);
+            if (fields == 0) continue; // player didn't change
+        }
+
+        custom_utils::write_varint(snapshot.player(selected.entry), result);
+        if (baseline != nullptr) result.push_back(fields);
+        custom_utils::write_compact_state(state, fields, result);
+        ++count;
+    }
+    if (baseline == nullptr) return count;
+
+    for (uint64_t player : interest.left) {
+        custom_utils::write_varint(player, result);
+        result.push_back(0);
+        ++count;
+    }
+    return count;
+}
+
+void Network::send_snapshot (Endpoint client, uint64_t id, const World_snapshot& snapshot, const Snapshot_interest& interest, const World_snapshot* baseline) {
+    // fec session - package goes into fec datagram, which is checksummed itself
+    m_snapshot_encoder.set_checked(not m_fec_encoders.contains(client));
+
+    auto compact = m_compact_configs.find(client);
+    if (compact != m_compact_configs.end()) {
+        uint64_t count = serialize_compact(snapshot, baseline, interest, compact->second, m_snapshot_delta);
+
+        m_snapshot_header.clear();
+        m_snapshot_header.push_back(static_cast<uint8_t>(baseline != nullptr ? Answer::Type::OTHER_DELTA_COMPACT : Answer::Type::OTHER_COMPACT));
+        custom_utils::write_varint(id, m_snapshot_header);
+        if (baseline != nullptr) custom_utils::write_varint(baseline->id(), m_snapshot_header);
+        custom_utils::write_varint(count, m_snapshot_header);
+        m_snapshot_encoder.update(m_snapshot_header);
+        m_snapshot_encoder.update(m_snapshot_delta);
+
+        send_serialized(client, m_snapshot_encoder);
         return;
     }
 
-    // get user info
-    addrinfo hints;
-    memset(&hints, 0, sizeof(hints));
-    hints.ai_family   = AF_INET;   // AF_INET or AF_INET6 (IPv4 or IPv6)
-    hints.ai_socktype = SOCK_DGRAM;  // UDP
-    hints.ai_protocol = 0;           // use default protocol implementation for UDP
-    addrinfo* result;
-    int error = getaddrinfo(ip.c_str(), port.c_str(), &hints, &result);
-    if (error != 0) {
-        std::osyncstream(std::cerr) << "User address resolution failed: " << gai_strerror(error) << '\n';
+    if (baseline != nullptr) {
+        uint64_t count = serialize_delta(snapshot, *baseline, interest, m_snapshot_delta);
+
+        uint8_t type = static_cast<uint8_t>(Answer::Type::OTHER_DELTA);
+        write_value(m_snapshot_encoder, type);
+        write_value(m_snapshot_encoder, ntohll(id));
+        write_value(m_snapshot_encoder, ntohll(baseline->id()));
+        write_value(m_snapshot_encoder, ntohll(count));
+        m_snapshot_encoder.update(m_snapshot_delta);
+
+        send_serialized(client, m_snapshot_encoder);
+        return;
+    }
+
+    uint8_t type = static_cast<uint8_t>(Answer::Type::OTHER);
+    write_value(m_snapshot_encoder, type);
+    write_value(m_snapshot_encoder, ntohll(id));
+    write_value(m_snapshot_encoder, ntohll(uint64_t(interest.entries.size())));
+
+    // selected entries are copied as they are - runs of neighbouring entries at once
+    for (size_t i = 0; i < interest.entries.size();) {
+        size_t begin = interest.entries[i].entry;
+        size_t end   = begin + 1;
+        for (++i; i < interest.entries.size() and interest.entries[i].entry == end; ++i) ++end;
+        m_snapshot_encoder.update(snapshot.entries(begin, end));
+    }
+
+    send_serialized(client, m_snapshot_encoder);
+}
+
+void Network::send_serialized (Endpoint client, custom_utils::Packet_encoder& encoder) {
+    auto fec_encoder = m_fec_encoders.find(client);
+    if (fec_encoder == m_fec_encoders.end()) {
+        if (not encoder.finish(m_snapshot_datagram)) {
+            response_bad_formed(client);
+            return;
+        }
+        send_encoded(client, m_snapshot_datagram);
         return;
     }
 
-    // FIXME case of long buffer - int overflow
-    error = sendto(m_server_socket, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0, result->ai_addr, static_cast<int>(result->ai_addrlen));
-    freeaddrinfo(result);
-    if (error == SOCKET_ERROR) {
-        std::osyncstream(std::cerr) << "Failed to send data to user: " << WSAGetLastError() << '\n';
+    // fec session - data datagram now, parity datagrams after last answer of group (or by flush_fec)
+    std::optional<std::vector<std::vector<uint8_t>>> datagrams = fec_encoder->second.push(encoder.package());
+    encoder.reset();
+    if (not datagrams.has_value()) {
+        response_bad_formed(client);
         return;
     }
+
+    for (auto& datagram : datagrams.value()) {
+        send_buffer(client, datagram);
+    }
+}
+
+void Network::send_buffer (Endpoint client, std::vector<uint8_t>& buffer) {
+    if (not encode_message(buffer)) {
+        response_bad_formed(client);
+        return;
+    }
+
+    send_encoded(client, buffer);
+}
+
+void Network::send_encoded (Endpoint client, std::span<const uint8_t> encoded) {
+    if (m_config.io_batch == 1 and m_shards.front()->socket.backend() == Socket_backend::EPOLL) {
+        m_shards.front()->socket.send(encoded, client.address());
+        return;
+    }
+
+    // batched network - sent by flush_answers
+    std::lock_guard<std::mutex> lock(mutex_outgoing);
+    m_outgoing.push_back(Outgoing{.offset=m_outgoing_data.size(), .size=encoded.size(), .to=client.address()});
+    m_outgoing_data.insert(m_outgoing_data.end(), encoded.begin(), encoded.end());
+    if (not m_has_outgoing.exchange(true)) m_message_signal.notify();
+}
+
+void Network::flush_fec () {
+    for (auto& [client, encoder] : m_fec_encoders) {
+        for (auto& datagram : encoder.flush(FEC_FLUSH_TIMEOUT)) send_buffer(client, datagram);
+    }
+}
+
+void Network::flush_answers () {
+    flush_fec();
+    {
+        std::lock_guard<std::mutex> lock(mutex_outgoing);
+        if (m_outgoing.empty()) return;
+        m_has_outgoing = false;
+        std::swap(m_outgoing, m_flushed);
+        std::swap(m_outgoing_data, m_flushed_data);
+    }
+
+    m_flushed_datagrams.clear();
+    for (const Outgoing& outgoing : m_flushed) {
+        m_flushed_datagrams.push_back({.data=std::span(m_flushed_data).subspan(outgoing.offset, outgoing.size), .to=outgoing.to});
+    }
+
+    // io_batch datagrams per syscall, io_uring - all of them are submitted together
+    Udp_socket& socket = m_shards.front()->socket;
+    size_t      batch  = (socket.backend() == Socket_backend::IO_URING) ? m_flushed_datagrams.size() : m_config.io_batch;
+    for (size_t i = 0; i < m_flushed_datagrams.size(); i += batch) {
+        socket.send_batch(std::span(m_flushed_datagrams).subspan(i, std::min(batch, m_flushed_datagrams.size() - i)));
+    }
+
+    m_flushed.clear();
+    m_flushed_data.clear();
+}
+
+Packet_ring_statistics Network::queue_statistics () const {
+    Packet_ring_statistics total;
+    for (const std::unique_ptr<Receive_shard>& shard : m_shards) {
+        for (const std::unique_ptr<Packet_ring>& messages : shard->messages) {
+            Packet_ring_statistics statistics = messages->statistics();
+            total.pushed  += statistics.pushed;
+            total.dropped += statistics.dropped;
+            total.full    += statistics.full;
+        }
+    }
+    return total;
+}
+
+Packet_pool_statistics Network::pool_statistics () const {
+    Packet_pool_statistics total;
+    for (const std::unique_ptr<Receive_shard>& shard : m_shards) {
+        Packet_pool_statistics statistics = shard->packets.statistics();
+        total.capacity   += statistics.capacity;
+        total.in_use     += statistics.in_use;
+        total.high_water += statistics.high_water;
+    }
+    return total;
+}
+
+Socket_statistics Network::io_statistics () const {
+    Socket_statistics total;
+    for (const std::unique_ptr<Receive_shard>& shard : m_shards) {
+        Socket_statistics statistics = shard->socket.statistics();
+        total.wait_calls         += statistics.wait_calls;
+        total.receive_calls      += statistics.receive_calls;
+        total.received_datagrams += statistics.received_datagrams;
+        total.send_calls         += statistics.send_calls;
+        total.sent_datagrams     += statistics.sent_datagrams;
+    }
+    return total;
+}
+
+// ===================================
+
+void World_snapshot::clear (uint64_t id) {
+    m_id = id;
+    m_ids.clear();
+    m_others.clear();
+    m_entries.clear();
+}
+
+void World_snapshot::add (const Answer::Other& other) {
+    m_ids.push_back(other.id);
+    m_others.push_back(other);
+    m_entries.resize(m_entries.size() + ENTRY_SIZE);
+    serialize_other(other, std::span(m_entries).last<ENTRY_SIZE>());
+}
+
+uint64_t World_snapshot::id () const {
+    return m_id;
+}
+
+size_t World_snapshot::size () const {
+    return m_ids.size();
+}
+
+uint64_t World_snapshot::player (size_t index) const {
+    return m_ids[index];
+}
+
+const Answer::Other& World_snapshot::other (size_t index) const {
+    return m_others[index];
+}
+
+std::optional<size_t> World_snapshot::find (uint64_t id, size_t hint) const {
+    if (hint < m_ids.size() and m_ids[hint] == id) return hint;
+    auto entry = std::find(m_ids.begin(), m_ids.end(), id);
+    if (entry == m_ids.end()) return std::nullopt;
+    return size_t(entry - m_ids.begin());
+}
+
+std::span<const uint8_t> World_snapshot::entries (size_t begin, size_t end) const {
+    return std::span(m_entries).subspan(begin * ENTRY_SIZE, (end - begin) * ENTRY_SIZE);
+}
+
+// ===================================
+
+World_snapshot& Snapshot_history::next (uint64_t id) {
+    m_latest = id;
+    World_snapshot& snapshot = m_snapshots[id % CAPACITY];
+    snapshot.clear(id);
+    return snapshot;
+}
+
+const World_snapshot& Snapshot_history::latest () const {
+    return m_snapshots[m_latest % CAPACITY];
+}
+
+const World_snapshot* Snapshot_history::find (uint64_t id) const {
+    const World_snapshot& snapshot = m_snapshots[id % CAPACITY];
+    if (id == 0 or snapshot.id() != id) return nullptr;
+    return &snapshot;
 }
@@ -1,25 +1,38 @@
 #ifndef NETWORK_H
 #define NETWORK_H
 
-#include <condition_variable>
+#include "Packet_pool.h"
+#include "Packet_ring.h"
+#include "Ring_queue.h"
+#include "Socket.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <compact_state.h>
+#include <error_repairing.h>
 #include <cstdint>
-#include <inaddr.h>
 #include <limits>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <packet_fec.h>
+#include <span>
 #include <string>
 #include <vector>
-#include <winsock2.h>
-#include <Ws2tcpip.h>
 #include <optional>
 
 
+// network byte order is big endian
 inline uint64_t ntohll(uint64_t value) {
-    return ((static_cast<uint64_t>(ntohl(value & 0xFFFFFFFF)) << 32) | ntohl(value >> 32));
+    if constexpr (std::endian::native == std::endian::little) return std::byteswap(value);
+    return value;
 }
 
 inline uint32_t ntohi(uint32_t value) {
-    return ((static_cast<uint32_t>(ntohs(value & 0xFFFF)) << 16) | ntohs(value >> 16));
+    if constexpr (std::endian::native == std::endian::little) return std::byteswap(value);
+    return value;
 }
 
 inline uint32_t htoni(uint32_t value) {
@@ -41,10 +54,12 @@ public:
         MESSAGE       =  1,
         GET_OTHER     =  2,
         FINISH        =  3,
-        BREAK_SESSION =  4
+        BREAK_SESSION =  4,
+        ACK_SNAPSHOT  =  5, // id - snapshot client has, baseline of next pushed deltas (0 - none)
+        COMPACT_MESSAGE = 6 // MESSAGE of compact session - id (varint) and quantized state
     };
     inline static const int MIN_TYPE = 0;
-    inline static const int MAX_TYPE = 4;
+    inline static const int MAX_TYPE = 6;
 
 public:
     Type type               = Type::EMPTY;
@@ -56,6 +71,9 @@ public:
     double ddx              = 0.0;
     double ddy              = 0.0;
     unsigned long long time = 0ll;
+    std::optional<custom_utils::Fec_config> fec = std::nullopt; // LOGIN - client asks for fec of answers
+    std::optional<custom_utils::Compact_config> compact = std::nullopt; // LOGIN - client asks for compact state
+    std::optional<custom_utils::Compact_state> compact_state = std::nullopt; // COMPACT_MESSAGE - instead of x ... time
 };
 
 
@@ -69,6 +87,9 @@ public:
         OTHER                 = 2,
         FINISH                = 3,
         BREAK_SESSION         = 4,
+        OTHER_DELTA           = 5, // changed fields of OTHER against snapshot acknowledged by client
+        OTHER_COMPACT         = 6, // OTHER and OTHER_DELTA of compact session - varints and quantized states
+        OTHER_DELTA_COMPACT   = 7,
     };
 public:
     struct Finish {
@@ -92,64 +113,246 @@ public:
     std::optional<unsigned long> id;
     std::optional<Finish> finish;
     std::optional<std::vector<Other>> other;
+    bool is_compact = false; // REGISTERED_ANSWER - compact state of login is accepted
+    bool is_pushing = false; // REGISTERED_ANSWER - snapshots are pushed after ticks (client doesn't ask for them)
+};
+
+/**
+ * Players of one tick serialized once - entries of OTHER answer in network byte order
+ * Answer of every client is its own header and copy of entries without its own one (Network::send_snapshot)
+ */
+class World_snapshot {
+public:
+    static constexpr size_t ENTRY_SIZE = 8 * sizeof(uint64_t); // id, x, y, dx, dy, ddx, ddy, time
+
+public:
+    void clear (uint64_t id); // memory of previous tick is kept
+    void add (const Answer::Other& other);
+
+    [[nodiscard]] uint64_t id () const; // number of snapshot, 0 - none
+    [[nodiscard]] size_t size () const;
+    [[nodiscard]] uint64_t player (size_t index) const; // id of player of entry
+    [[nodiscard]] const Answer::Other& other (size_t index) const; // state of entry - compact answers quantize it for client
+    [[nodiscard]] std::optional<size_t> find (uint64_t id, size_t hint = 0) const; // entry of player, hint - its probable entry
+    [[nodiscard]] std::span<const uint8_t> entries (size_t begin, size_t end) const; // serialized entries [begin, end)
+
+private:
+    uint64_t              m_id = 0;
+    std::vector<uint64_t>      m_ids; // id of every entry
+    std::vector<uint8_t>       m_entries;
+    std::vector<Answer::Other> m_others;
+};
+
+/**
+ * Players of snapshot sent to one client (area of interest of requester, chosen by Players)
+ */
+struct Snapshot_interest {
+    static constexpr uint32_t NO_BASELINE = ~uint32_t(0);
+
+    struct Entry {
+        uint32_t entry;                  // entry of snapshot
+        uint32_t baseline = NO_BASELINE; // entry of player in baseline known by client, NO_BASELINE - sent whole
+    };
+    std::vector<Entry>    entries; // in order of snapshot, requester isn't there
+    std::vector<uint64_t> left;    // players which left server after baseline (client keeps players out of area of interest)
+};
+
+/**
+ * Last snapshots - baselines of deltas for clients which acknowledged them
+ */
+class Snapshot_history {
+public:
+    static constexpr size_t CAPACITY = 32; // ticks - older acknowledges get whole snapshot
+
+public:
+    World_snapshot& next (uint64_t id); // cleared snapshot in place of oldest one
+    [[nodiscard]] const World_snapshot& latest () const;
+    [[nodiscard]] const World_snapshot* find (uint64_t id) const; // nullptr - not kept anymore (or 0)
+
+private:
+    std::array<World_snapshot, CAPACITY> m_snapshots;
+    uint64_t                             m_latest = 0;
 };
 
 struct Network_package {
     Package package;
-    std::string ip;
-    std::string port;
+    Endpoint endpoint;
 };
 
 struct Raw_message {
     std::vector<uint8_t> package;
-    std::string ip;
-    std::string port;
+    Endpoint endpoint;
+};
+
+// result of decode worker - fec datagram is restored by reader (fec sessions are kept by reader thread)
+struct Decoded_message {
+    Network_package      package;
+    std::vector<uint8_t> fec; // not empty - fec datagram, package has only endpoint
+};
+
+struct Network_config {
+    // datagrams per receive/send syscall (recvmmsg/sendmmsg), 1 - recvfrom/sendto for every datagram
+    // answers of batched network are sent by flush_answers
+    size_t io_batch = 1;
+    // sockets on server port (SO_REUSEPORT), each is received by own thread into own queue
+    // client always comes to the same socket - order of its packages is kept
+    size_t receive_shards = 1;
+    // io_uring falls back to epoll when it is unavailable, its answers are always sent by flush_answers
+    Socket_backend backend = Socket_backend::EPOLL;
+    // buffers of received datagrams of one shard (Packet_buffer::CAPACITY each), queue has the same amount of slots
+    size_t packet_buffers = 1024;
+    // threads which decode, check and parse datagrams before reader takes them, 0 - reader does it itself
+    // client always comes to the same worker - order of its packages is kept
+    size_t decode_workers = 0;
 };
 
 class Network {
 public:
-    Network ();
+    explicit Network (Network_config config = {});
     ~Network ();
     Network (const Network& network) = delete;
 
 public:
-    void socket_main ();
+    /**
+     * @brief receive thread of one socket, shard < receive_shards()
+     */
+    void socket_main (size_t shard = 0);
+    [[nodiscard]] size_t receive_shards () const;
+    /**
+     * @brief decode thread, worker < decode_workers() - bad formed datagrams are answered by it
+     */
+    void decode_main (size_t worker);
+    [[nodiscard]] size_t decode_workers () const;
 
 public:
     [[nodiscard]] bool is_server_running() const;
     [[nodiscard]] bool has_message();
+    /**
+     * @brief reader sleeps until receive thread (or decode worker) queues message or answer waits for flush_answers
+     * @return false when server was stopped
+     */
+    bool wait_message ();
 
 public:
     std::optional<Network_package> pop_message ();
     void stop_server ();
+    /**
+     * @brief sends answers waiting since last flush (batched network), once per tick
+     */
+    void flush_answers ();
+    [[nodiscard]] Socket_statistics io_statistics () const; // sum of all shards
+    [[nodiscard]] Packet_ring_statistics queue_statistics () const; // sum of all shards
+    [[nodiscard]] Packet_pool_statistics pool_statistics () const; // sum of all shards (high water - sum of shards' ones)
+
+public:
+    void registered_acknowledge  (Endpoint client, bool is_compact = false, bool is_pushing = false);
+    void acknowledge             (Endpoint client, uint64_t id);
+    void acknowledge             (Endpoint client, std::span<const uint64_t> ids); // all ids of tick, every id is encoded and sent on its own
+    void response_bad_formed     (Endpoint client);
+    void deleted_acknowledge     (Endpoint client);
+    /**
+     * @brief OTHER answer from snapshot of tick - entries of interest are copied
+     *        with baseline (snapshot acknowledged by client) - OTHER_DELTA with changed fields only
+     */
+    void send_snapshot           (Endpoint client, uint64_t id, const World_snapshot& snapshot, const Snapshot_interest& interest,
+                                  const World_snapshot* baseline = nullptr);
 
 public:
-    void registered_acknowledge  (const std::string& ip, const std::string& port);
-    void acknowledge             (const std::string& ip, const std::string& port, uint64_t id);
-    void response_bad_formed     (const std::string& ip, const std::string& port);
-    void deleted_acknowledge     (const std::string& ip, const std::string& port);
-    void send_info_of_other      (const std::string& ip, const std::string& port, uint64_t id, const std::vector<Answer::Other>& other);
+    // fec of send_snapshot for one session (reader thread only)
+    void enable_fec  (Endpoint client, custom_utils::Fec_config config);
+    void disable_fec (Endpoint client);
+    // compact state of send_snapshot for one session (reader thread only)
+    void enable_compact  (Endpoint client, custom_utils::Compact_config config);
+    void disable_compact (Endpoint client);
 
 private:
-    bool setup_socket ();
-    void process_error (const SOCKADDR_IN& client_address);
+    bool setup_socket (size_t shard);
+    void process_error (Socket_error error, Endpoint client);
+    static size_t receive_one (Udp_socket& socket, Received_datagram& datagram, Socket_error& error); // recvfrom - socket_main without batches
 
 private:
-    void push_message (std::string&& client, std::string&& port, std::vector<uint8_t>&& message);
-    static bool decode_message (std::vector<uint8_t>& message);
-    static std::optional<Package> parse_message (const std::vector<uint8_t>& message);
+    size_t decode_queue (Endpoint client) const; // queue of shard (and decode worker) for client
+    Ring_signal& queue_signal (size_t queue); // consumer of queue - reader or decode worker
+    bool has_packet (size_t queue) const;
+    Packet_handle next_packet (size_t queue, size_t& next_shard); // from queues of shards in turn, empty handle when all are empty
+    std::optional<Decoded_message> next_decoded (); // from decode workers in turn
+
+private:
+    std::optional<Decoded_message> decode_packet (const Packet_handle& packet); // decode, check and parse - any thread
+    static std::optional<size_t> decode_message (std::span<uint8_t> message);
+    bool restore_message (Raw_message& raw_message); // fec datagrams - false when there is no package yet
+    std::optional<Network_package> parse_raw_message (Raw_message& raw_message);
+    static std::optional<Package> parse_message (std::span<const uint8_t> message);
 
 private:
     static bool encode_message (std::vector<uint8_t>& message);
-    static void serialize_answer (const Answer& answer, std::vector<uint8_t>& buffer); // helper for send_answer
-    void send_answer (const std::string& ip, const std::string& port, const Answer& answer);
+    static void serialize_answer (const Answer& answer, custom_utils::Packet_encoder& encoder); // helper for send_answer
+    void send_answer (Endpoint client, const Answer& answer);
+    void send_serialized (Endpoint client, custom_utils::Packet_encoder& encoder); // fec session or one datagram, encoder is reset
+    void send_buffer (Endpoint client, std::vector<uint8_t>& buffer);
+    void send_encoded (Endpoint client, std::span<const uint8_t> encoded); // helper for send_buffer
+    void flush_fec (); // parity of fec groups older than FEC_FLUSH_TIMEOUT - by flush_answers
 
 private:
-    SOCKET m_server_socket;
-    std::mutex mutex_messages;
-    std::condition_variable cv_has_message;
-    std::list<Raw_message> messages;
-    bool server_running = true;
+    static constexpr uint16_t                  SERVER_PORT     = 20123;
+    static constexpr std::chrono::milliseconds RECEIVE_TIMEOUT = std::chrono::milliseconds(100); // socket_main checks stop of server
+    static constexpr std::chrono::milliseconds MAX_BACKPRESSURE = std::chrono::milliseconds(50); // full queue - then datagrams are dropped
+    static constexpr std::chrono::milliseconds FULL_QUEUE_SLEEP = std::chrono::milliseconds(1);
+    static constexpr std::chrono::milliseconds FEC_FLUSH_TIMEOUT = std::chrono::milliseconds(100); // groups of pushed snapshots are full before it
+
+private:
+    Network_config m_config;
+
+    // socket and queues of one receive thread
+    struct Receive_shard {
+        Udp_socket  socket;
+        Packet_pool packets;
+        std::vector<std::unique_ptr<Packet_ring>> messages; // ids of packets - queue for every decode worker (one for reader without them)
+
+        Receive_shard (size_t packet_buffers, size_t queues): packets(packet_buffers) {
+            for (size_t i = 0; i < queues; ++i) messages.push_back(std::make_unique<Packet_ring>(packet_buffers));
+        }
+    };
+    std::vector<std::unique_ptr<Receive_shard>> m_shards; // answers are sent by socket of shard 0
+    size_t m_next_shard = 0; // next_packet (reader thread only)
+
+    // decode thread - takes packets of its queue of every shard
+    struct Decode_worker {
+        Ring_queue<Decoded_message> decoded;
+        Ring_signal                 packet_signal; // woken by receive threads
+
+        explicit Decode_worker (size_t capacity): decoded(capacity) {}
+    };
+    std::vector<std::unique_ptr<Decode_worker>> m_workers;
+    size_t m_next_worker = 0; // next_decoded (reader thread only)
+
+    // answers waiting for flush_answers - encoded datagrams one after another
+    struct Outgoing {
+        size_t         offset;
+        size_t         size;
+        Socket_address to;
+    };
+    std::mutex                 mutex_outgoing;
+    std::vector<uint8_t>       m_outgoing_data;
+    std::vector<Outgoing>      m_outgoing;
+    std::vector<uint8_t>       m_flushed_data; // swapped with outgoing - sent without lock
+    std::vector<Outgoing>      m_flushed;
+    std::vector<Sent_datagram> m_flushed_datagrams;
+    std::atomic<bool>          m_has_outgoing = false; // answers of decode workers wake reader
+    Ring_signal m_message_signal; // reader is woken by receive threads (or decode workers)
+    std::atomic<bool> server_running = true;
+
+    // fec sessions (reader thread only)
+    std::map<Endpoint, custom_utils::Fec_encoder> m_fec_encoders;
+    std::map<Endpoint, custom_utils::Fec_decoder> m_fec_decoders;
+    std::list<Raw_message> m_restored_messages; // decoded packages restored by fec, waiting for pop_message
+
+    // send_snapshot (reader thread only) - memory is reused by answers of all clients
+    custom_utils::Packet_encoder m_snapshot_encoder;
+    std::vector<uint8_t>         m_snapshot_datagram;
+    std::vector<uint8_t>         m_snapshot_delta;
+    std::vector<uint8_t>         m_snapshot_header; // compact answers - varints
+    std::map<Endpoint, custom_utils::Compact_config> m_compact_configs;
 };
 
 
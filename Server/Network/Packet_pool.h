@@ -0,0 +1,181 @@
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include "Socket.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+/**
+ * Buffers of received datagrams - allocated once, one datagram is written to its buffer exactly once:
+ * socket receives into buffer, decoder fixes it in place, parser reads the same memory
+ * Buffers are allocated by one thread (receive thread of shard) and released by any thread (Packet_handle)
+ */
+
+struct Packet_buffer {
+    static constexpr size_t CAPACITY = 1024; // bigger datagrams are cut (protocol packages are much smaller)
+
+    Socket_address                from;
+    size_t                        size = 0;
+    std::array<uint8_t, CAPACITY> data;
+
+    [[nodiscard]] std::span<uint8_t> payload () { return std::span(data).first(size); }
+
+private:
+    friend class Packet_pool;
+    std::atomic<uint32_t> m_references = 0;
+    uint32_t              m_next_free  = 0; // free list
+};
+
+// occupancy of pool
+struct Packet_pool_statistics {
+    uint64_t capacity   = 0;
+    uint64_t in_use     = 0; // allocated and not released yet
+    uint64_t high_water = 0; // max of in_use since start
+};
+
+class Packet_pool {
+public:
+    static constexpr uint32_t NO_BUFFER = ~uint32_t(0);
+
+public:
+    explicit Packet_pool (size_t capacity);
+    Packet_pool (const Packet_pool& pool) = delete;
+    Packet_pool& operator= (const Packet_pool& pool) = delete;
+
+public:
+    // allocating thread
+    /**
+     * @brief fills ids with free buffers (one reference each)
+     * @return amount of allocated buffers, 0 - pool is empty
+     */
+    size_t allocate (std::span<uint32_t> ids);
+    void   unallocate (uint32_t id); // allocated buffer wasn't used - back without atomics
+
+public:
+    // any thread
+    [[nodiscard]] Packet_buffer& buffer (uint32_t id) { return m_buffers[id]; }
+    void retain (uint32_t id);
+    void release (uint32_t id); // buffer is free when last reference is released
+
+    [[nodiscard]] Packet_pool_statistics statistics () const;
+
+private:
+    std::unique_ptr<Packet_buffer[]> m_buffers;
+    size_t                           m_capacity;
+
+    // released buffers - stack of any thread, taken by allocating thread all at once (one popping thread - no ABA)
+    std::atomic<uint32_t> m_released = NO_BUFFER;
+    std::vector<uint32_t> m_free; // allocating thread only
+
+    std::atomic<uint64_t> m_in_use     = 0;
+    std::atomic<uint64_t> m_high_water = 0;
+};
+
+/**
+ * Shared reference to buffer of pool - buffer is released with the last handle
+ */
+class Packet_handle {
+public:
+    Packet_handle () = default;
+    ~Packet_handle () { reset(); }
+
+    Packet_handle (const Packet_handle& handle): m_pool(handle.m_pool), m_id(handle.m_id) {
+        if (m_pool != nullptr) m_pool->retain(m_id);
+    }
+    Packet_handle (Packet_handle&& handle) noexcept
+        : m_pool(std::exchange(handle.m_pool, nullptr)), m_id(std::exchange(handle.m_id, Packet_pool::NO_BUFFER)) {}
+
+    Packet_handle& operator= (Packet_handle handle) noexcept {
+        std::swap(m_pool, handle.m_pool);
+        std::swap(m_id, handle.m_id);
+        return *this;
+    }
+
+    /**
+     * @brief takes reference of allocate (or of queue) - no retain
+     */
+    static Packet_handle adopt (Packet_pool& pool, uint32_t id) {
+        Packet_handle handle;
+        handle.m_pool = &pool;
+        handle.m_id   = id;
+        return handle;
+    }
+
+    void reset () {
+        if (m_pool != nullptr) m_pool->release(m_id);
+        m_pool = nullptr;
+        m_id   = Packet_pool::NO_BUFFER;
+    }
+
+    [[nodiscard]] explicit operator bool () const { return m_pool != nullptr; }
+    Packet_buffer& operator* () const { return m_pool->buffer(m_id); }
+    Packet_buffer* operator-> () const { return &m_pool->buffer(m_id); }
+
+private:
+    Packet_pool* m_pool = nullptr;
+    uint32_t     m_id   = Packet_pool::NO_BUFFER;
+};
+
+// ===================================
+
+inline Packet_pool::Packet_pool (size_t capacity)
+    : m_buffers(std::make_unique<Packet_buffer[]>(capacity)), m_capacity(capacity) {
+    m_free.reserve(capacity);
+    for (size_t i = capacity; i > 0; --i) m_free.push_back(uint32_t(i - 1));
+}
+
+inline size_t Packet_pool::allocate (std::span<uint32_t> ids) {
+    // take all released buffers at once
+    if (m_free.size() < ids.size()) {
+        for (uint32_t id = m_released.exchange(NO_BUFFER, std::memory_order_acquire); id != NO_BUFFER; id = m_buffers[id].m_next_free) {
+            m_free.push_back(id);
+        }
+    }
+
+    size_t amount = std::min(ids.size(), m_free.size());
+    for (size_t i = 0; i < amount; ++i) {
+        ids[i] = m_free.back();
+        m_free.pop_back();
+        m_buffers[ids[i]].m_references.store(1, std::memory_order_relaxed);
+    }
+
+    uint64_t in_use = m_in_use.fetch_add(amount, std::memory_order_relaxed) + amount;
+    if (in_use > m_high_water.load(std::memory_order_relaxed)) m_high_water.store(in_use, std::memory_order_relaxed); // only allocating thread raises it
+    return amount;
+}
+
+inline void Packet_pool::unallocate (uint32_t id) {
+    m_free.push_back(id);
+    m_in_use.fetch_sub(1, std::memory_order_relaxed);
+}
+
+inline void Packet_pool::retain (uint32_t id) {
+    m_buffers[id].m_references.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline void Packet_pool::release (uint32_t id) {
+    if (m_buffers[id].m_references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    m_in_use.fetch_sub(1, std::memory_order_relaxed); // before buffer can be allocated again - high water isn't raised by it
+
+    uint32_t head = m_released.load(std::memory_order_relaxed);
+    do {
+        m_buffers[id].m_next_free = head;
+    } while (not m_released.compare_exchange_weak(head, id, std::memory_order_release, std::memory_order_relaxed));
+}
+
+inline Packet_pool_statistics Packet_pool::statistics () const {
+    return Packet_pool_statistics{
+        .capacity   = m_capacity,
+        .in_use     = m_in_use.load(std::memory_order_relaxed),
+        .high_water = m_high_water.load(std::memory_order_relaxed),
+    };
+}
+
+#endif // PACKET_POOL_H
@@ -0,0 +1,49 @@
+#ifndef PACKET_RING_H
+#define PACKET_RING_H
+
+#include "Ring_queue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Queue of received datagrams - one producer (receive thread of shard), one consumer (reader thread or decode worker)
+ * Queue passes ids of Packet_pool buffers (with their reference), datagrams themselves aren't copied
+ */
+
+// counters of ring since start
+struct Packet_ring_statistics {
+    uint64_t pushed  = 0; // datagrams given to consumer
+    uint64_t dropped = 0; // datagrams received when there was no free buffer for too long
+    uint64_t full    = 0; // times producer found no free buffer (backpressure - it stopped receiving)
+};
+
+class Packet_ring : public Ring_queue<uint32_t> {
+public:
+    explicit Packet_ring (size_t capacity): Ring_queue<uint32_t>(capacity) {}
+
+public:
+    // producer
+    void push (std::span<const uint32_t> ids) { // ids.size() <= free_slots()
+        Ring_queue<uint32_t>::push(ids);
+        m_pushed.fetch_add(ids.size(), std::memory_order_relaxed);
+    }
+    void count_full () { m_full.fetch_add(1, std::memory_order_relaxed); }
+    void count_dropped (size_t amount) { m_dropped.fetch_add(amount, std::memory_order_relaxed); }
+
+    [[nodiscard]] Packet_ring_statistics statistics () const {
+        return Packet_ring_statistics{
+            .pushed  = m_pushed.load(std::memory_order_relaxed),
+            .dropped = m_dropped.load(std::memory_order_relaxed),
+            .full    = m_full.load(std::memory_order_relaxed),
+        };
+    }
+
+private:
+    std::atomic<uint64_t> m_pushed  = 0;
+    std::atomic<uint64_t> m_dropped = 0;
+    std::atomic<uint64_t> m_full    = 0;
+};
+
+#endif // PACKET_RING_H
@@ -0,0 +1,117 @@
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+/**
+ * Bounded lock-free queue - one producer thread, one consumer thread
+ * Slots are allocated once, items are moved in by push and moved out by consumer before pop
+ */
+template <class T>
+class Ring_queue {
+public:
+    /**
+     * @param capacity - rounded up to power of 2
+     */
+    explicit Ring_queue (size_t capacity)
+        : m_mask(std::bit_ceil(capacity < 2 ? size_t(2) : capacity) - 1),
+          m_slots(std::make_unique<T[]>(m_mask + 1)) {}
+    Ring_queue (const Ring_queue& queue) = delete;
+    Ring_queue& operator= (const Ring_queue& queue) = delete;
+
+public:
+    // producer
+    [[nodiscard]] size_t free_slots () const {
+        return m_mask + 1 - (m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire));
+    }
+
+    bool push (T&& item) {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) > m_mask) return false; // full
+
+        m_slots[tail & m_mask] = std::move(item);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push (std::span<const T> items) { // items.size() <= free_slots()
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < items.size(); ++i) m_slots[(tail + i) & m_mask] = items[i];
+        m_tail.store(tail + items.size(), std::memory_order_release);
+    }
+
+public:
+    // consumer
+    [[nodiscard]] bool empty () const {
+        return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+    }
+
+    T* front () { // nullptr when empty
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cached_tail) {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cached_tail) return nullptr;
+        }
+        return &m_slots[head & m_mask];
+    }
+
+    void pop () {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    size_t               m_mask;
+    std::unique_ptr<T[]> m_slots;
+
+    // consumer and producer write on own cache line, consumer caches tail - it reads it for every item
+    // (producer reads head once per push)
+    alignas(CACHE_LINE) std::atomic<size_t> m_head = 0; // next slot of consumer
+    size_t                                  m_cached_tail = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> m_tail = 0; // next slot of producer
+};
+
+/**
+ * Sleep of consumer of ring queues (futex of std::atomic::wait) - producer wakes consumer only when it is waiting,
+ * there is no syscall for items of busy consumer
+ */
+class Ring_signal {
+public:
+    /**
+     * @brief sleeps until notify, is_ready is checked after consumer is marked as waiting - item pushed before it isn't missed
+     */
+    template <class Predicate>
+    void wait (Predicate is_ready) {
+        uint32_t value = m_value.load();
+        m_is_waiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pairs with fence of notify
+        if (not is_ready()) m_value.wait(value);
+        m_is_waiting.store(false);
+    }
+
+    void notify () { // after push of producer
+        std::atomic_thread_fence(std::memory_order_seq_cst); // pushed items are visible before flag is read
+        if (not m_is_waiting.load(std::memory_order_relaxed)) return;
+
+        m_value.fetch_add(1);
+        m_value.notify_one();
+    }
+
+    void notify_all () { // stop - consumer wakes even when it isn't marked as waiting yet
+        m_value.fetch_add(1);
+        m_value.notify_all();
+    }
+
+private:
+    std::atomic<uint32_t> m_value      = 0; // futex word - changed when consumer is woken
+    std::atomic<bool>     m_is_waiting = false;
+};
+
+#endif // RING_QUEUE_H
@@ -0,0 +1,189 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+/**
+ * UDP socket of server, backend is chosen by platform (only one of them is built):
+ *     Socket_winsock.cpp - Winsock
+ *     Socket_posix.cpp   - POSIX, event loop waits with epoll, on Linux socket can use io_uring instead (Socket_backend)
+ * Socket is non-blocking: wait for datagrams, then receive until Socket_error::WOULD_BLOCK
+ * Batches use recvmmsg/sendmmsg on Linux (one syscall for batch), other backends call receive/send for every datagram
+ * Sharded receive - several sockets are opened on the same port with SO_REUSEPORT (POSIX only),
+ * kernel chooses socket by hash of 4-tuple, so datagrams of one client always come to the same socket
+ */
+
+#ifdef _WIN32
+using Native_socket = uintptr_t; // SOCKET
+inline constexpr Native_socket INVALID_NATIVE_SOCKET = ~Native_socket(0);
+#else
+using Native_socket = int;
+inline constexpr Native_socket INVALID_NATIVE_SOCKET = -1;
+#endif
+
+enum class Socket_backend : uint8_t {
+    EPOLL    = 0, // wait by epoll (select on Winsock), datagrams by recvfrom/recvmmsg
+    IO_URING = 1, // Linux - multishot receive into buffers of kernel ring, sends are submitted by one io_uring_enter
+};
+
+// IPv4 address of datagram
+struct Socket_address {
+    uint32_t ip   = 0; // network byte order
+    uint16_t port = 0; // host byte order
+
+    [[nodiscard]] std::string ip_string () const;
+    [[nodiscard]] std::string port_string () const;
+};
+
+// client of server - address of its datagrams packed into one integer, kept for whole session
+// (answers are sent to it without name resolution and string formatting)
+class Endpoint {
+public:
+    constexpr Endpoint () = default;
+    constexpr explicit Endpoint (const Socket_address& address): m_value((uint64_t(address.ip) << 16) | address.port) {}
+
+    [[nodiscard]] constexpr Socket_address address () const { return Socket_address{.ip=uint32_t(m_value >> 16), .port=uint16_t(m_value)}; }
+    [[nodiscard]] constexpr uint64_t value () const { return m_value; } // ip << 16 | port
+    [[nodiscard]] std::string to_string () const { return address().ip_string() + ":" + address().port_string(); } // logs only
+
+    constexpr auto operator<=> (const Endpoint& endpoint) const = default;
+
+private:
+    uint64_t m_value = 0;
+};
+
+enum class Socket_error : uint8_t {
+    NONE             = 0,
+    WOULD_BLOCK      = 1, // no more datagrams now
+    CONNECTION_RESET = 2, // previous datagram wasn't delivered - client was closed (Winsock: WSAECONNRESET, POSIX: ECONNREFUSED)
+    OTHER            = 3,
+};
+
+// slot of receive_batch - buffer is given by caller, size and from are filled by socket
+// io_uring - buffer is replaced by span of socket's buffer (provided ring), it is valid until next receive_batch
+struct Received_datagram {
+    std::span<uint8_t> buffer;
+    size_t             size = 0;
+    Socket_address     from;
+};
+
+struct Sent_datagram {
+    std::span<const uint8_t> data;
+    Socket_address           to;
+};
+
+// syscalls and datagrams of socket since open
+struct Socket_statistics {
+    uint64_t wait_calls         = 0;
+    uint64_t receive_calls      = 0;
+    uint64_t received_datagrams = 0;
+    uint64_t send_calls         = 0;
+    uint64_t sent_datagrams     = 0;
+};
+
+class Udp_socket {
+public:
+    Udp_socket ();
+    ~Udp_socket ();
+    Udp_socket (const Udp_socket& socket) = delete;
+    Udp_socket& operator= (const Udp_socket& socket) = delete;
+
+public:
+    /**
+     * @brief socket library of platform, once for process (WSAStartup/WSACleanup)
+     */
+    static bool startup ();
+    static bool cleanup ();
+    /**
+     * @brief getaddrinfo - for addresses given by user, not for every datagram (see Endpoint)
+     * @return std::nullopt when address can't be resolved
+     */
+    static std::optional<Socket_address> resolve (const std::string& ip, const std::string& port);
+    /**
+     * @return true when several sockets can be opened on one port (open with reuse_port)
+     */
+    static bool supports_reuse_port ();
+    /**
+     * @return true when io_uring with multishot receive can be created (Linux only)
+     */
+    static bool supports_io_uring ();
+
+public:
+    /**
+     * @brief non-blocking socket bound to port of all interfaces
+     * @param reuse_port - SO_REUSEPORT, port is shared with other sockets of process (only when supports_reuse_port)
+     * @param backend    - IO_URING falls back to EPOLL when io_uring can't be created, see backend()
+     */
+    bool open (uint16_t port, bool reuse_port = false, Socket_backend backend = Socket_backend::EPOLL);
+    void close ();
+    [[nodiscard]] bool is_open () const;
+    [[nodiscard]] Socket_backend backend () const;
+
+    /**
+     * @return true when datagram can be received, false on timeout or error
+     */
+    bool wait (std::chrono::milliseconds timeout);
+    /**
+     * @return size of datagram (cut to buffer size), std::nullopt on error (error == WOULD_BLOCK - no datagram)
+     */
+    std::optional<size_t> receive (std::span<uint8_t> buffer, Socket_address& from, Socket_error& error);
+    bool send (std::span<const uint8_t> data, const Socket_address& to);
+
+    /**
+     * @brief receives up to datagrams.size() datagrams (one thread at a time)
+     * @return amount of received datagrams, 0 on error (error == WOULD_BLOCK - no datagram)
+     */
+    size_t receive_batch (std::span<Received_datagram> datagrams, Socket_error& error);
+    /**
+     * @brief sends all datagrams (one thread at a time), datagram that can't be sent is skipped
+     * @return amount of sent datagrams
+     */
+    size_t send_batch (std::span<const Sent_datagram> datagrams);
+
+    [[nodiscard]] Socket_statistics statistics () const;
+
+private:
+    struct Batch_buffers; // headers of batch syscalls - defined by backend
+    struct Counters {
+        std::atomic<uint64_t> wait_calls         = 0;
+        std::atomic<uint64_t> receive_calls      = 0;
+        std::atomic<uint64_t> received_datagrams = 0;
+        std::atomic<uint64_t> send_calls         = 0;
+        std::atomic<uint64_t> sent_datagrams     = 0;
+    };
+
+    static void count (std::atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+#ifdef __linux__
+    // io_uring backend (Socket_posix.cpp)
+    bool   open_uring ();
+    void   close_uring ();
+    bool   arm_uring_receive ();
+    bool   recycle_uring_receive (); // gives back buffers of last receive, arms receive again when it was stopped
+    bool   wait_uring (std::chrono::milliseconds timeout);
+    size_t receive_uring (std::span<Received_datagram> datagrams, Socket_error& error);
+    size_t send_uring (std::span<const Sent_datagram> datagrams); // sendmmsg after error of send ring (it is closed)
+    size_t send_mmsg (std::span<const Sent_datagram> datagrams);
+    void   prepare_send_headers (std::span<const Sent_datagram> datagrams); // shared by sendmmsg and io_uring
+#endif
+
+private:
+    Native_socket  m_socket  = INVALID_NATIVE_SOCKET;
+    Socket_backend m_backend = Socket_backend::EPOLL;
+#ifndef _WIN32
+    int            m_epoll   = -1;
+#endif
+    std::unique_ptr<Batch_buffers> m_batch_buffers;
+    Counters                       m_counters;
+};
+
+#endif // SOCKET_H
@@ -0,0 +1,608 @@
+#include "Socket.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <syncstream>
+#include <unistd.h>
+#include <vector>
+#ifdef __linux__
+#include "Uring.h"
+#endif
+
+#ifdef __linux__
+// io_uring backend
+static constexpr unsigned int URING_BUFFERS       = 512;  // datagrams received and not processed yet
+static constexpr size_t       URING_BUFFER_SIZE   = 2048; // io_uring_recvmsg_out + address + datagram
+static constexpr uint16_t     URING_BUFFER_GROUP  = 0;
+static constexpr unsigned int URING_SEND_ENTRIES  = 256;  // sends of one io_uring_enter
+static constexpr uint64_t     URING_RECEIVE_TAG   = 1;    // user_data of cqe
+static constexpr uint64_t     URING_SEND_TAG      = 2;
+static constexpr size_t       URING_SEND_RETRIES  = 16;   // submits failed by lack of resources before ring is given up
+#endif
+
+// headers of recvmmsg/sendmmsg - resized to biggest batch, receive and send are used by different threads
+struct Udp_socket::Batch_buffers {
+#ifdef __linux__
+    std::vector<mmsghdr>     receive_headers;
+    std::vector<iovec>       receive_vectors;
+    std::vector<sockaddr_in> receive_addresses;
+
+    std::vector<mmsghdr>     send_headers;
+    std::vector<iovec>       send_vectors;
+    std::vector<sockaddr_in> send_addresses;
+
+    // io_uring - own ring for receive and for send (rings are used by different threads)
+    Uring_buffer_ring     receive_pool; // before rings - rings are closed first
+    Uring                 receive_ring;
+    msghdr                receive_message{};  // multishot recvmsg - only size of address is used
+    bool                  is_receive_armed = false;
+    std::vector<uint16_t> used_buffers;       // datagrams of last receive, given back to kernel by next one
+    Uring                 send_ring;
+#endif
+};
+
+static Socket_error receive_error () {
+    switch (errno) {
+        case EAGAIN: // == EWOULDBLOCK
+        case EINTR:
+            return Socket_error::WOULD_BLOCK;
+        case ECONNREFUSED:
+            return Socket_error::CONNECTION_RESET;
+        default:
+            std::osyncstream(std::cerr) << "Socket receive failed: " << strerror(errno) << '\n';
+            return Socket_error::OTHER;
+    }
+}
+
+static sockaddr_in to_sockaddr (const Socket_address& socket_address) {
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = socket_address.ip;
+    address.sin_port        = htons(socket_address.port);
+    return address;
+}
+
+std::string Socket_address::ip_string () const {
+    in_addr address{.s_addr=ip};
+    char buffer[INET_ADDRSTRLEN];
+    if (inet_ntop(AF_INET, &address, buffer, sizeof(buffer)) == nullptr) return {};
+    return buffer;
+}
+
+std::string Socket_address::port_string () const {
+    return std::to_string(port);
+}
+
+// ===================================
+
+Udp_socket::Udp_socket (): m_batch_buffers(std::make_unique<Batch_buffers>()) {}
+
+Udp_socket::~Udp_socket () {
+    close();
+}
+
+bool Udp_socket::startup () {
+    return true; // nothing to start
+}
+
+bool Udp_socket::cleanup () {
+    return true;
+}
+
+std::optional<Socket_address> Udp_socket::resolve (const std::string& ip, const std::string& port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;     // AF_INET or AF_INET6 (IPv4 or IPv6)
+    hints.ai_socktype = SOCK_DGRAM;  // UDP
+    hints.ai_protocol = 0;           // use default protocol implementation for UDP
+    addrinfo* result;
+    int error = getaddrinfo(ip.c_str(), port.c_str(), &hints, &result);
+    if (error != 0) {
+        std::osyncstream(std::cerr) << "User address resolution failed: " << gai_strerror(error) << '\n';
+        return std::nullopt;
+    }
+
+    const sockaddr_in* address = reinterpret_cast<const sockaddr_in*>(result->ai_addr);
+    Socket_address socket_address{.ip=address->sin_addr.s_addr, .port=ntohs(address->sin_port)};
+    freeaddrinfo(result);
+    return socket_address;
+}
+
+bool Udp_socket::supports_io_uring () {
+#ifdef __linux__
+    Uring             ring;
+    Uring_buffer_ring pool;
+    return ring.setup(2, 4) and pool.setup(ring, 2, URING_BUFFER_SIZE, URING_BUFFER_GROUP);
+#else
+    return false;
+#endif
+}
+
+bool Udp_socket::supports_reuse_port () {
+#ifdef SO_REUSEPORT
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ===================================
+
+bool Udp_socket::open (uint16_t port, bool reuse_port, Socket_backend backend) {
+    // UDP socket
+    m_socket = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_socket == INVALID_NATIVE_SOCKET) {
+        std::osyncstream(std::cerr) << "Socket creation failed: " << strerror(errno) << '\n';
+        return false;
+    }
+
+    // set socket options
+    int opt = 1;
+    if (setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) != 0) {
+        std::osyncstream(std::cerr) << "Socket modification failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+
+#ifdef SO_REUSEPORT
+    if (reuse_port and setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) != 0) {
+        std::osyncstream(std::cerr) << "Socket modification failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+#else
+    if (reuse_port) {
+        std::osyncstream(std::cerr) << "Socket modification failed: SO_REUSEPORT is not supported" << '\n';
+        close();
+        return false;
+    }
+#endif
+
+    // binding
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(port);
+    if (bind(m_socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        std::osyncstream(std::cerr) << "Socket binding failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+
+    m_backend = Socket_backend::EPOLL;
+    if (backend == Socket_backend::IO_URING) {
+#ifdef __linux__
+        if (open_uring()) {
+            m_backend = Socket_backend::IO_URING;
+            return true;
+        }
+        close_uring();
+#endif
+        std::osyncstream(std::cerr) << "Socket io_uring is unavailable, epoll is used" << '\n';
+    }
+
+    // event loop - level triggered, so not received datagrams wake next wait again
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events  = EPOLLIN;
+    event.data.fd = m_socket;
+    if (m_epoll == -1 or epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_socket, &event) != 0) {
+        std::osyncstream(std::cerr) << "Socket event loop creation failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void Udp_socket::close () {
+#ifdef __linux__
+    close_uring();
+#endif
+    if (m_epoll != -1) ::close(m_epoll);
+    if (m_socket != INVALID_NATIVE_SOCKET) ::close(m_socket);
+    m_epoll  = -1;
+    m_socket = INVALID_NATIVE_SOCKET;
+}
+
+bool Udp_socket::is_open () const {
+    return m_socket != INVALID_NATIVE_SOCKET;
+}
+
+Socket_backend Udp_socket::backend () const {
+    return m_backend;
+}
+
+bool Udp_socket::wait (std::chrono::milliseconds timeout) {
+#ifdef __linux__
+    if (m_backend == Socket_backend::IO_URING) return wait_uring(timeout);
+#endif
+    count(m_counters.wait_calls);
+
+    epoll_event event;
+    int amount = epoll_wait(m_epoll, &event, 1, static_cast<int>(timeout.count()));
+    if (amount == -1 and errno != EINTR) {
+        std::osyncstream(std::cerr) << "Socket wait failed: " << strerror(errno) << '\n';
+    }
+    return amount > 0;
+}
+
+std::optional<size_t> Udp_socket::receive (std::span<uint8_t> buffer, Socket_address& from, Socket_error& error) {
+#ifdef __linux__
+    if (m_backend == Socket_backend::IO_URING) {
+        Received_datagram datagram{.buffer=buffer, .size=0, .from={}};
+        if (receive_uring(std::span(&datagram, 1), error) == 0) return std::nullopt;
+
+        size_t size = std::min(datagram.size, buffer.size());
+        std::copy_n(datagram.buffer.begin(), size, buffer.begin());
+        from = datagram.from;
+        return size;
+    }
+#endif
+    count(m_counters.receive_calls);
+
+    sockaddr_in address;
+    socklen_t   address_size = sizeof(address);
+    memset(&address, 0, sizeof(address));
+
+    ssize_t data_size = recvfrom(m_socket, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&address), &address_size);
+    from = Socket_address{.ip=address.sin_addr.s_addr, .port=ntohs(address.sin_port)};
+
+    if (data_size < 0) {
+        error = receive_error();
+        return std::nullopt;
+    }
+
+    count(m_counters.received_datagrams);
+    error = Socket_error::NONE;
+    return static_cast<size_t>(data_size);
+}
+
+bool Udp_socket::send (std::span<const uint8_t> data, const Socket_address& to) {
+#ifdef __linux__
+    if (m_backend == Socket_backend::IO_URING) {
+        Sent_datagram datagram{.data=data, .to=to};
+        return send_uring(std::span(&datagram, 1)) == 1;
+    }
+#endif
+    count(m_counters.send_calls);
+
+    sockaddr_in address = to_sockaddr(to);
+    if (sendto(m_socket, data.data(), data.size(), 0, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == -1) {
+        std::osyncstream(std::cerr) << "Failed to send data to user: " << strerror(errno) << '\n';
+        return false;
+    }
+
+    count(m_counters.sent_datagrams);
+    return true;
+}
+
+#ifdef __linux__
+
+size_t Udp_socket::receive_batch (std::span<Received_datagram> datagrams, Socket_error& error) {
+    if (m_backend == Socket_backend::IO_URING) return receive_uring(datagrams, error);
+
+    Batch_buffers& buffers = *m_batch_buffers;
+    if (buffers.receive_headers.size() < datagrams.size()) {
+        buffers.receive_headers.resize(datagrams.size());
+        buffers.receive_vectors.resize(datagrams.size());
+        buffers.receive_addresses.resize(datagrams.size());
+    }
+
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        buffers.receive_vectors[i] = iovec{.iov_base=datagrams[i].buffer.data(), .iov_len=datagrams[i].buffer.size()};
+
+        msghdr& header     = buffers.receive_headers[i].msg_hdr;
+        header             = msghdr{};
+        header.msg_name    = &buffers.receive_addresses[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov     = &buffers.receive_vectors[i];
+        header.msg_iovlen  = 1;
+    }
+
+    count(m_counters.receive_calls);
+    int amount = recvmmsg(m_socket, buffers.receive_headers.data(), static_cast<unsigned int>(datagrams.size()), MSG_DONTWAIT, nullptr);
+    if (amount <= 0) {
+        error = amount == 0 ? Socket_error::WOULD_BLOCK : receive_error();
+        return 0;
+    }
+
+    for (size_t i = 0; i < size_t(amount); ++i) {
+        const sockaddr_in& address = buffers.receive_addresses[i];
+        datagrams[i].size = buffers.receive_headers[i].msg_len;
+        datagrams[i].from = Socket_address{.ip=address.sin_addr.s_addr, .port=ntohs(address.sin_port)};
+    }
+
+    count(m_counters.received_datagrams, size_t(amount));
+    error = Socket_error::NONE;
+    return size_t(amount);
+}
+
+size_t Udp_socket::send_batch (std::span<const Sent_datagram> datagrams) {
+    if (m_backend == Socket_backend::IO_URING) return send_uring(datagrams);
+    return send_mmsg(datagrams);
+}
+
+size_t Udp_socket::send_mmsg (std::span<const Sent_datagram> datagrams) {
+    Batch_buffers& buffers = *m_batch_buffers;
+    prepare_send_headers(datagrams);
+
+    // sendmmsg stops at first failed datagram - it is skipped, others are sent by next call
+    size_t sent = 0;
+    for (size_t i = 0; i < datagrams.size();) {
+        count(m_counters.send_calls);
+        int amount = sendmmsg(m_socket, buffers.send_headers.data() + i, static_cast<unsigned int>(datagrams.size() - i), 0);
+        if (amount <= 0) {
+            std::osyncstream(std::cerr) << "Failed to send data to user: " << strerror(errno) << '\n';
+            ++i;
+            continue;
+        }
+        i    += size_t(amount);
+        sent += size_t(amount);
+    }
+
+    count(m_counters.sent_datagrams, sent);
+    return sent;
+}
+
+void Udp_socket::prepare_send_headers (std::span<const Sent_datagram> datagrams) {
+    Batch_buffers& buffers = *m_batch_buffers;
+    if (buffers.send_headers.size() < datagrams.size()) {
+        buffers.send_headers.resize(datagrams.size());
+        buffers.send_vectors.resize(datagrams.size());
+        buffers.send_addresses.resize(datagrams.size());
+    }
+
+    for (size_t i = 0; i < datagrams.size(); ++i) {
+        buffers.send_addresses[i] = to_sockaddr(datagrams[i].to);
+        buffers.send_vectors[i]   = iovec{.iov_base=const_cast<uint8_t*>(datagrams[i].data.data()), .iov_len=datagrams[i].data.size()};
+
+        msghdr& header     = buffers.send_headers[i].msg_hdr;
+        header             = msghdr{};
+        header.msg_name    = &buffers.send_addresses[i];
+        header.msg_namelen = sizeof(sockaddr_in);
+        header.msg_iov     = &buffers.send_vectors[i];
+        header.msg_iovlen  = 1;
+    }
+}
+
+// ===================================
+// io_uring backend
+// ===================================
+
+bool Udp_socket::open_uring () {
+    Batch_buffers& buffers = *m_batch_buffers;
+
+    // receive - kernel takes buffers of pool, one cqe for every datagram
+    if (not buffers.receive_ring.setup(8, URING_BUFFERS * 2)) return false;
+    if (not buffers.receive_ring.register_file(m_socket)) return false;
+    if (not buffers.receive_pool.setup(buffers.receive_ring, URING_BUFFERS, URING_BUFFER_SIZE, URING_BUFFER_GROUP)) return false;
+
+    // send
+    if (not buffers.send_ring.setup(URING_SEND_ENTRIES, URING_SEND_ENTRIES * 2)) return false;
+    if (not buffers.send_ring.register_file(m_socket)) return false;
+
+    buffers.receive_message             = msghdr{};
+    buffers.receive_message.msg_namelen = sizeof(sockaddr_in);
+    buffers.used_buffers.clear();
+    if (not arm_uring_receive()) return false;
+
+    // multishot receive isn't supported by kernel (< 6.0) - it fails at once
+    const io_uring_cqe* cqe = buffers.receive_ring.peek_cqe();
+    if (cqe != nullptr and cqe->res == -EINVAL) {
+        std::osyncstream(std::cerr) << "Socket multishot receive isn't supported by kernel" << '\n';
+        return false;
+    }
+    return true;
+}
+
+void Udp_socket::close_uring () {
+    Batch_buffers& buffers = *m_batch_buffers;
+    buffers.receive_ring.close();
+    buffers.receive_pool.close();
+    buffers.send_ring.close();
+    buffers.is_receive_armed = false;
+}
+
+bool Udp_socket::arm_uring_receive () {
+    Batch_buffers& buffers = *m_batch_buffers;
+
+    io_uring_sqe* sqe = buffers.receive_ring.get_sqe();
+    if (sqe == nullptr) return false;
+    sqe->opcode    = IORING_OP_RECVMSG;
+    sqe->fd        = 0; // fixed file of socket
+    sqe->flags     = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->ioprio    = IORING_RECV_MULTISHOT;
+    sqe->addr      = reinterpret_cast<uint64_t>(&buffers.receive_message);
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = URING_RECEIVE_TAG;
+
+    count(m_counters.receive_calls);
+    int result = buffers.receive_ring.submit();
+    if (result < 0) {
+        std::osyncstream(std::cerr) << "Socket receive failed: " << strerror(-result) << '\n';
+        return false;
+    }
+    buffers.is_receive_armed = true;
+    return true;
+}
+
+bool Udp_socket::recycle_uring_receive () {
+    Batch_buffers& buffers = *m_batch_buffers;
+
+    // datagrams of previous receive are processed by caller
+    if (not buffers.used_buffers.empty()) {
+        for (uint16_t id : buffers.used_buffers) buffers.receive_pool.give_back(id);
+        buffers.receive_pool.publish();
+        buffers.used_buffers.clear();
+    }
+    // multishot receive stops when pool is empty (or on error) - datagrams wait in socket until it is armed again
+    return buffers.is_receive_armed or arm_uring_receive();
+}
+
+bool Udp_socket::wait_uring (std::chrono::milliseconds timeout) {
+    Uring& ring = m_batch_buffers->receive_ring;
+    if (ring.peek_cqe() != nullptr) return true;
+    if (not recycle_uring_receive()) return false;
+
+    count(m_counters.wait_calls);
+    int result = ring.submit(1, timeout);
+    if (result < 0 and result != -ETIME and result != -EINTR) {
+        std::osyncstream(std::cerr) << "Socket wait failed: " << strerror(-result) << '\n';
+    }
+    return ring.peek_cqe() != nullptr;
+}
+
+size_t Udp_socket::receive_uring (std::span<Received_datagram> datagrams, Socket_error& error) {
+    Batch_buffers& buffers = *m_batch_buffers;
+    if (not recycle_uring_receive()) {
+        error = Socket_error::OTHER;
+        return 0;
+    }
+
+    size_t amount = 0;
+    while (amount < datagrams.size()) {
+        const io_uring_cqe* cqe = buffers.receive_ring.peek_cqe();
+        if (cqe == nullptr) break;
+        int32_t  result = cqe->res;
+        uint32_t flags  = cqe->flags;
+        buffers.receive_ring.advance_cqe();
+
+        if (not (flags & IORING_CQE_F_MORE)) buffers.is_receive_armed = false;
+        if (result < 0) {
+            if (result != -ENOBUFS and result != -ECONNREFUSED) {
+                std::osyncstream(std::cerr) << "Socket receive failed: " << strerror(-result) << '\n';
+            }
+            continue;
+        }
+        if (not (flags & IORING_CQE_F_BUFFER)) continue;
+
+        // buffer: io_uring_recvmsg_out, address (msg_namelen), datagram
+        uint16_t           id     = uint16_t(flags >> IORING_CQE_BUFFER_SHIFT);
+        std::span<uint8_t> buffer = buffers.receive_pool.buffer(id);
+        buffers.used_buffers.push_back(id);
+
+        io_uring_recvmsg_out out;
+        sockaddr_in          address;
+        memcpy(&out, buffer.data(), sizeof(out));
+        memcpy(&address, buffer.data() + sizeof(out), sizeof(address));
+        size_t offset = sizeof(out) + buffers.receive_message.msg_namelen;
+
+        datagrams[amount].buffer = buffer.subspan(offset, std::min<size_t>(out.payloadlen, buffer.size() - offset));
+        datagrams[amount].size   = datagrams[amount].buffer.size();
+        datagrams[amount].from   = Socket_address{.ip=address.sin_addr.s_addr, .port=ntohs(address.sin_port)};
+        ++amount;
+    }
+
+    if (amount == 0) {
+        error = Socket_error::WOULD_BLOCK;
+        return 0;
+    }
+
+    count(m_counters.received_datagrams, amount);
+    error = Socket_error::NONE;
+    return amount;
+}
+
+size_t Udp_socket::send_uring (std::span<const Sent_datagram> datagrams) {
+    Batch_buffers& buffers = *m_batch_buffers;
+    Uring&         ring    = buffers.send_ring;
+    if (not ring.is_open()) return send_mmsg(datagrams);
+    prepare_send_headers(datagrams);
+
+    // one io_uring_enter submits sendmsg of all datagrams (up to URING_SEND_ENTRIES) and waits for them -
+    // data of datagrams isn't owned by socket, so no send is left in ring when this returns
+    size_t sent = 0;
+    for (size_t i = 0; i < datagrams.size();) {
+        size_t amount = std::min<size_t>(datagrams.size() - i, URING_SEND_ENTRIES);
+        bool   is_failed = false;
+        for (size_t j = 0; j < amount; ++j) {
+            io_uring_sqe* sqe = ring.get_sqe();
+            if (sqe == nullptr) { // ring is always empty here - it is broken
+                is_failed = true;
+                break;
+            }
+            sqe->opcode    = IORING_OP_SENDMSG;
+            sqe->fd        = 0; // fixed file of socket
+            sqe->flags     = IOSQE_FIXED_FILE;
+            sqe->addr      = reinterpret_cast<uint64_t>(&buffers.send_headers[i + j].msg_hdr);
+            sqe->user_data = URING_SEND_TAG;
+        }
+
+        // lack of resources - completions are taken and sqes left in ring are submitted again
+        size_t completed = 0;
+        size_t retries   = 0;
+        while (completed < amount and not is_failed) {
+            const io_uring_cqe* cqe = ring.peek_cqe();
+            if (cqe == nullptr) {
+                count(m_counters.send_calls);
+                int result = ring.submit(unsigned(amount - completed));
+                if (result >= 0 or result == -EINTR) continue;
+                if ((result == -EAGAIN or result == -EBUSY) and ++retries < URING_SEND_RETRIES) continue;
+
+                std::osyncstream(std::cerr) << "Failed to send data to user: " << strerror(-result) << '\n';
+                is_failed = true;
+                break;
+            }
+
+            if (cqe->res < 0) {
+                std::osyncstream(std::cerr) << "Failed to send data to user: " << strerror(-cqe->res) << '\n';
+            } else {
+                ++sent;
+            }
+            ring.advance_cqe();
+            ++completed;
+        }
+        i += amount;
+
+        if (is_failed) {
+            // closed ring cancels its sends (they don't use data of datagrams anymore) - next datagrams go by sendmmsg,
+            // not completed ones of this chunk are lost
+            std::osyncstream(std::cerr) << "Socket io_uring send failed, sendmmsg is used" << '\n';
+            ring.close();
+            count(m_counters.sent_datagrams, sent);
+            return sent + send_mmsg(datagrams.subspan(i));
+        }
+    }
+
+    count(m_counters.sent_datagrams, sent);
+    return sent;
+}
+
+#else
+
+size_t Udp_socket::receive_batch (std::span<Received_datagram> datagrams, Socket_error& error) {
+    size_t amount = 0;
+    for (; amount < datagrams.size(); ++amount) {
+        std::optional<size_t> size = receive(datagrams[amount].buffer, datagrams[amount].from, error);
+        if (not size.has_value()) break;
+        datagrams[amount].size = size.value();
+    }
+    if (amount != 0) error = Socket_error::NONE;
+    return amount;
+}
+
+size_t Udp_socket::send_batch (std::span<const Sent_datagram> datagrams) {
+    return size_t(std::ranges::count_if(datagrams, [this](const Sent_datagram& datagram) { return send(datagram.data, datagram.to); }));
+}
+
+#endif
+
+Socket_statistics Udp_socket::statistics () const {
+    return Socket_statistics{
+        .wait_calls         = m_counters.wait_calls.load(std::memory_order_relaxed),
+        .receive_calls      = m_counters.receive_calls.load(std::memory_order_relaxed),
+        .received_datagrams = m_counters.received_datagrams.load(std::memory_order_relaxed),
+        .send_calls         = m_counters.send_calls.load(std::memory_order_relaxed),
+        .sent_datagrams     = m_counters.sent_datagrams.load(std::memory_order_relaxed),
+    };
+}
@@ -0,0 +1,236 @@
+#include "Socket.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <syncstream>
+#include <winsock2.h>
+#include <Ws2tcpip.h>
+
+// Winsock has no batch syscalls - datagrams of batch are received/sent one by one
+struct Udp_socket::Batch_buffers {};
+
+std::string Socket_address::ip_string () const {
+    in_addr address;
+    address.s_addr = ip;
+    char buffer[INET_ADDRSTRLEN];
+    if (inet_ntop(AF_INET, &address, buffer, sizeof(buffer)) == nullptr) return {};
+    return buffer;
+}
+
+std::string Socket_address::port_string () const {
+    return std::to_string(port);
+}
+
+// ===================================
+
+Udp_socket::Udp_socket (): m_batch_buffers(std::make_unique<Batch_buffers>()) {}
+
+Udp_socket::~Udp_socket () {
+    close();
+}
+
+bool Udp_socket::startup () {
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+        std::osyncstream(std::cerr) << "Socket startup failed: " << WSAGetLastError() << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool Udp_socket::cleanup () {
+    if (WSACleanup() != 0) {
+        std::osyncstream(std::cerr) << "Socket shutdown failed: " << WSAGetLastError() << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<Socket_address> Udp_socket::resolve (const std::string& ip, const std::string& port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family   = AF_INET;     // AF_INET or AF_INET6 (IPv4 or IPv6)
+    hints.ai_socktype = SOCK_DGRAM;  // UDP
+    hints.ai_protocol = 0;           // use default protocol implementation for UDP
+    addrinfo* result;
+    int error = getaddrinfo(ip.c_str(), port.c_str(), &hints, &result);
+    if (error != 0) {
+        std::osyncstream(std::cerr) << "User address resolution failed: " << gai_strerror(error) << '\n';
+        return std::nullopt;
+    }
+
+    const SOCKADDR_IN* address = reinterpret_cast<const SOCKADDR_IN*>(result->ai_addr);
+    Socket_address socket_address{.ip=address->sin_addr.s_addr, .port=ntohs(address->sin_port)};
+    freeaddrinfo(result);
+    return socket_address;
+}
+
+bool Udp_socket::supports_reuse_port () {
+    return false; // SO_REUSEADDR of Winsock doesn't balance datagrams between sockets
+}
+
+// ===================================
+
+bool Udp_socket::supports_io_uring () {
+    return false;
+}
+
+bool Udp_socket::open (uint16_t port, bool reuse_port, Socket_backend backend) {
+    if (reuse_port) {
+        std::osyncstream(std::cerr) << "Socket modification failed: SO_REUSEPORT is not supported" << '\n';
+        return false;
+    }
+    if (backend != Socket_backend::EPOLL) {
+        std::osyncstream(std::cerr) << "Socket backend isn't supported, select is used" << '\n';
+    }
+    m_backend = Socket_backend::EPOLL;
+
+    // UDP socket
+    m_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (m_socket == INVALID_SOCKET) {
+        std::osyncstream(std::cerr) << "Socket creation failed: " << WSAGetLastError() << '\n';
+        return false;
+    }
+
+    // set socket options
+    int opt = 1;
+    if (setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, (char*)&opt, sizeof(opt)) == SOCKET_ERROR) {
+        std::osyncstream(std::cerr) << "Socket modification failed: " << WSAGetLastError() << '\n';
+        close();
+        return false;
+    }
+
+    u_long is_non_blocking = 1;
+    if (ioctlsocket(m_socket, FIONBIO, &is_non_blocking) == SOCKET_ERROR) {
+        std::osyncstream(std::cerr) << "Socket modification failed: " << WSAGetLastError() << '\n';
+        close();
+        return false;
+    }
+
+    // binding
+    SOCKADDR_IN address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port        = htons(port);
+    if (bind(m_socket, reinterpret_cast<const SOCKADDR*>(&address), sizeof(address)) == SOCKET_ERROR) {
+        std::osyncstream(std::cerr) << "Socket binding failed: " << WSAGetLastError() << '\n';
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void Udp_socket::close () {
+    if (m_socket != INVALID_NATIVE_SOCKET) closesocket(m_socket);
+    m_socket = INVALID_NATIVE_SOCKET;
+}
+
+bool Udp_socket::is_open () const {
+    return m_socket != INVALID_NATIVE_SOCKET;
+}
+
+Socket_backend Udp_socket::backend () const {
+    return m_backend;
+}
+
+bool Udp_socket::wait (std::chrono::milliseconds timeout) {
+    count(m_counters.wait_calls);
+
+    fd_set sockets;
+    FD_ZERO(&sockets);
+    FD_SET(m_socket, &sockets);
+
+    TIMEVAL time;
+    time.tv_sec  = static_cast<long>(timeout.count() / 1000);
+    time.tv_usec = static_cast<long>(timeout.count() % 1000 * 1000);
+
+    int amount = select(0, &sockets, nullptr, nullptr, &time); // first argument is ignored by Winsock
+    if (amount == SOCKET_ERROR) {
+        std::osyncstream(std::cerr) << "Socket wait failed: " << WSAGetLastError() << '\n';
+    }
+    return amount > 0;
+}
+
+std::optional<size_t> Udp_socket::receive (std::span<uint8_t> buffer, Socket_address& from, Socket_error& error) {
+    count(m_counters.receive_calls);
+
+    SOCKADDR_IN address;
+    int         address_size = sizeof(address);
+    memset(&address, 0, sizeof(address));
+
+    int data_size = recvfrom(m_socket, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0, reinterpret_cast<SOCKADDR*>(&address), &address_size);
+    from = Socket_address{.ip=address.sin_addr.s_addr, .port=ntohs(address.sin_port)};
+
+    if (data_size != SOCKET_ERROR) {
+        count(m_counters.received_datagrams);
+        error = Socket_error::NONE;
+        return static_cast<size_t>(data_size);
+    }
+
+    int wsa_error = WSAGetLastError();
+    switch (wsa_error) {
+        case WSAEWOULDBLOCK:
+            error = Socket_error::WOULD_BLOCK;
+            break;
+        case WSAECONNRESET: // this seems to be get when client is disconnects - in connection less protocol ;(
+            error = Socket_error::CONNECTION_RESET;
+            break;
+        case WSAEMSGSIZE: // datagram is bigger than buffer - cut datagram is received
+            count(m_counters.received_datagrams);
+            error = Socket_error::NONE;
+            return buffer.size();
+        default:
+            std::osyncstream(std::cerr) << "Socket receive failed: " << wsa_error << '\n';
+            error = Socket_error::OTHER;
+            break;
+    }
+    return std::nullopt;
+}
+
+bool Udp_socket::send (std::span<const uint8_t> data, const Socket_address& to) {
+    count(m_counters.send_calls);
+
+    SOCKADDR_IN address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = to.ip;
+    address.sin_port        = htons(to.port);
+
+    // FIXME case of long buffer - int overflow
+    int error = sendto(m_socket, reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()), 0, reinterpret_cast<const SOCKADDR*>(&address), sizeof(address));
+    if (error == SOCKET_ERROR) {
+        std::osyncstream(std::cerr) << "Failed to send data to user: " << WSAGetLastError() << '\n';
+        return false;
+    }
+
+    count(m_counters.sent_datagrams);
+    return true;
+}
+
+size_t Udp_socket::receive_batch (std::span<Received_datagram> datagrams, Socket_error& error) {
+    size_t amount = 0;
+    for (; amount < datagrams.size(); ++amount) {
+        std::optional<size_t> size = receive(datagrams[amount].buffer, datagrams[amount].from, error);
+        if (not size.has_value()) break;
+        datagrams[amount].size = size.value();
+    }
+    if (amount != 0) error = Socket_error::NONE;
+    return amount;
+}
+
+size_t Udp_socket::send_batch (std::span<const Sent_datagram> datagrams) {
+    return size_t(std::ranges::count_if(datagrams, [this](const Sent_datagram& datagram) { return send(datagram.data, datagram.to); }));
+}
+
+Socket_statistics Udp_socket::statistics () const {
+    return Socket_statistics{
+        .wait_calls         = m_counters.wait_calls.load(std::memory_order_relaxed),
+        .receive_calls      = m_counters.receive_calls.load(std::memory_order_relaxed),
+        .received_datagrams = m_counters.received_datagrams.load(std::memory_order_relaxed),
+        .send_calls         = m_counters.send_calls.load(std::memory_order_relaxed),
+        .sent_datagrams     = m_counters.sent_datagrams.load(std::memory_order_relaxed),
+    };
+}
@@ -0,0 +1,252 @@
+#include "Uring.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <syncstream>
+#include <unistd.h>
+
+static int io_uring_setup (unsigned int entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int io_uring_enter (int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags, const void* argument, size_t argument_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, argument, argument_size));
+}
+
+static int io_uring_register (int fd, unsigned int opcode, const void* argument, unsigned int amount) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, argument, amount));
+}
+
+// head/tail are shared with kernel
+static unsigned int load_acquire (const unsigned int* value) {
+    return std::atomic_ref<const unsigned int>(*value).load(std::memory_order_acquire);
+}
+
+static void store_release (unsigned int* value, unsigned int new_value) {
+    std::atomic_ref<unsigned int>(*value).store(new_value, std::memory_order_release);
+}
+
+// ===================================
+
+Uring::~Uring () {
+    close();
+}
+
+bool Uring::setup (unsigned int entries, unsigned int completion_entries) {
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags      = IORING_SETUP_CQSIZE;
+    params.cq_entries = completion_entries;
+
+    m_fd = io_uring_setup(entries, &params);
+    if (m_fd < 0) {
+        std::osyncstream(std::cerr) << "Uring creation failed: " << strerror(errno) << '\n';
+        m_fd = -1;
+        return false;
+    }
+    // wait with timeout (5.11) and fixed buffer rings (5.19) are needed - ext arg is checked, others fail on register
+    if (not (params.features & IORING_FEAT_EXT_ARG)) {
+        std::osyncstream(std::cerr) << "Uring creation failed: kernel is too old" << '\n';
+        close();
+        return false;
+    }
+
+    m_submission_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    m_completion_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        m_submission_map_size = std::max(m_submission_map_size, m_completion_map_size);
+        m_completion_map_size = m_submission_map_size;
+    }
+
+    m_submission_map = mmap(nullptr, m_submission_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING);
+    if (m_submission_map == MAP_FAILED) {
+        m_submission_map = nullptr;
+        std::osyncstream(std::cerr) << "Uring mapping failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        m_completion_map = m_submission_map;
+    } else {
+        m_completion_map = mmap(nullptr, m_completion_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING);
+        if (m_completion_map == MAP_FAILED) {
+            m_completion_map = nullptr;
+            std::osyncstream(std::cerr) << "Uring mapping failed: " << strerror(errno) << '\n';
+            close();
+            return false;
+        }
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes  = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        std::osyncstream(std::cerr) << "Uring mapping failed: " << strerror(errno) << '\n';
+        close();
+        return false;
+    }
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    uint8_t* submission  = static_cast<uint8_t*>(m_submission_map);
+    m_submission_head    = reinterpret_cast<unsigned int*>(submission + params.sq_off.head);
+    m_submission_tail    = reinterpret_cast<unsigned int*>(submission + params.sq_off.tail);
+    m_submission_array   = reinterpret_cast<unsigned int*>(submission + params.sq_off.array);
+    m_submission_mask    = *reinterpret_cast<unsigned int*>(submission + params.sq_off.ring_mask);
+    m_submission_entries = params.sq_entries;
+
+    uint8_t* completion = static_cast<uint8_t*>(m_completion_map);
+    m_completion_head   = reinterpret_cast<unsigned int*>(completion + params.cq_off.head);
+    m_completion_tail   = reinterpret_cast<unsigned int*>(completion + params.cq_off.tail);
+    m_completion_mask   = *reinterpret_cast<unsigned int*>(completion + params.cq_off.ring_mask);
+    m_cqes              = reinterpret_cast<io_uring_cqe*>(completion + params.cq_off.cqes);
+    return true;
+}
+
+void Uring::close () {
+    if (m_sqes != nullptr) munmap(m_sqes, m_sqes_size);
+    if (m_completion_map != nullptr and m_completion_map != m_submission_map) munmap(m_completion_map, m_completion_map_size);
+    if (m_submission_map != nullptr) munmap(m_submission_map, m_submission_map_size);
+    if (m_fd != -1) ::close(m_fd);
+
+    m_sqes           = nullptr;
+    m_completion_map = nullptr;
+    m_submission_map = nullptr;
+    m_fd             = -1;
+    m_to_submit      = 0;
+}
+
+bool Uring::is_open () const {
+    return m_fd != -1;
+}
+
+bool Uring::register_file (int fd) {
+    if (io_uring_register(m_fd, IORING_REGISTER_FILES, &fd, 1) < 0) {
+        std::osyncstream(std::cerr) << "Uring file registration failed: " << strerror(errno) << '\n';
+        return false;
+    }
+    return true;
+}
+
+bool Uring::register_buffer_ring (void* ring, unsigned int entries, uint16_t group) {
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr    = reinterpret_cast<uint64_t>(ring);
+    registration.ring_entries = entries;
+    registration.bgid         = group;
+
+    if (io_uring_register(m_fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        std::osyncstream(std::cerr) << "Uring buffer ring registration failed: " << strerror(errno) << '\n';
+        return false;
+    }
+    return true;
+}
+
+io_uring_sqe* Uring::get_sqe () {
+    unsigned int head = load_acquire(m_submission_head);
+    unsigned int tail = *m_submission_tail + m_to_submit;
+    if (tail - head >= m_submission_entries) return nullptr;
+
+    unsigned int  index = tail & m_submission_mask;
+    io_uring_sqe* sqe   = &m_sqes[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    m_submission_array[index] = index;
+    ++m_to_submit;
+    return sqe;
+}
+
+int Uring::submit (unsigned int wait_for, std::optional<std::chrono::milliseconds> timeout) {
+    // taken sqes become visible to kernel - ones not consumed by failed submit are submitted again
+    store_release(m_submission_tail, *m_submission_tail + m_to_submit);
+    unsigned int to_submit = *m_submission_tail - load_acquire(m_submission_head);
+    m_to_submit = 0;
+
+    unsigned int flags = (wait_for != 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    __kernel_timespec      time;
+    io_uring_getevents_arg argument;
+    memset(&argument, 0, sizeof(argument));
+    if (timeout.has_value()) {
+        time.tv_sec         = timeout->count() / 1000;
+        time.tv_nsec        = timeout->count() % 1000 * 1000000;
+        argument.sigmask_sz = _NSIG / 8;
+        argument.ts         = reinterpret_cast<uint64_t>(&time);
+        flags |= IORING_ENTER_EXT_ARG;
+    }
+
+    int result = io_uring_enter(m_fd, to_submit, wait_for, flags,
+                                timeout.has_value() ? &argument : nullptr,
+                                timeout.has_value() ? sizeof(argument) : _NSIG / 8);
+    return result < 0 ? -errno : result;
+}
+
+const io_uring_cqe* Uring::peek_cqe () {
+    unsigned int head = *m_completion_head;
+    if (head == load_acquire(m_completion_tail)) return nullptr;
+    return &m_cqes[head & m_completion_mask];
+}
+
+void Uring::advance_cqe () {
+    store_release(m_completion_head, *m_completion_head + 1);
+}
+
+// ===================================
+
+Uring_buffer_ring::~Uring_buffer_ring () {
+    close();
+}
+
+bool Uring_buffer_ring::setup (Uring& uring, unsigned int entries, size_t buffer_size, uint16_t group) {
+    m_entries     = entries;
+    m_buffer_size = buffer_size;
+    m_ring_size   = entries * sizeof(io_uring_buf);
+
+    // ring has to be page aligned - mapped memory
+    void* ring = mmap(nullptr, m_ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED) {
+        std::osyncstream(std::cerr) << "Uring buffer ring allocation failed: " << strerror(errno) << '\n';
+        return false;
+    }
+    m_ring    = static_cast<io_uring_buf_ring*>(ring);
+    m_buffers = new uint8_t[entries * buffer_size];
+
+    if (not uring.register_buffer_ring(m_ring, entries, group)) {
+        close();
+        return false;
+    }
+
+    // all buffers are given to kernel at start
+    m_tail = 0;
+    for (unsigned int i = 0; i < entries; ++i) {
+        give_back(uint16_t(i));
+    }
+    publish();
+    return true;
+}
+
+void Uring_buffer_ring::close () {
+    if (m_ring != nullptr) munmap(m_ring, m_ring_size);
+    delete[] m_buffers;
+    m_ring    = nullptr;
+    m_buffers = nullptr;
+}
+
+std::span<uint8_t> Uring_buffer_ring::buffer (uint16_t id) {
+    return std::span(m_buffers + size_t(id) * m_buffer_size, m_buffer_size);
+}
+
+void Uring_buffer_ring::give_back (uint16_t id) {
+    // not m_ring->bufs - flex array of header is moved behind empty struct in C++, entries start at ring itself (tail is in first one)
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(m_ring)[m_tail & (m_entries - 1)];
+    entry.addr = reinterpret_cast<uint64_t>(m_buffers + size_t(id) * m_buffer_size);
+    entry.len  = static_cast<uint32_t>(m_buffer_size);
+    entry.bid  = id;
+    ++m_tail;
+}
+
+void Uring_buffer_ring::publish () {
+    std::atomic_ref<uint16_t>(m_ring->tail).store(m_tail, std::memory_order_release);
+}
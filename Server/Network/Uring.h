@@ -0,0 +1,111 @@
+#ifndef URING_H
+#define URING_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <optional>
+#include <span>
+
+/**
+ * Minimal io_uring (Linux only) over raw syscalls - liburing isn't required
+ * One ring is used by one thread at a time: sqes are taken and cqes are read without locks
+ */
+class Uring {
+public:
+    Uring () = default;
+    ~Uring ();
+    Uring (const Uring& uring) = delete;
+    Uring& operator= (const Uring& uring) = delete;
+
+public:
+    /**
+     * @brief io_uring_setup and mapping of rings
+     * @return false when io_uring is unavailable (old kernel, disabled by kernel.io_uring_disabled, seccomp)
+     */
+    bool setup (unsigned int entries, unsigned int completion_entries);
+    void close ();
+    [[nodiscard]] bool is_open () const;
+
+    /**
+     * @brief fd becomes fixed file 0 (IOSQE_FIXED_FILE)
+     */
+    bool register_file (int fd);
+    /**
+     * @brief memory of provided buffer ring (page aligned, entries * sizeof(io_uring_buf)) for IOSQE_BUFFER_SELECT
+     */
+    bool register_buffer_ring (void* ring, unsigned int entries, uint16_t group);
+
+    /**
+     * @return next sqe (zeroed), nullptr when submission queue is full
+     */
+    io_uring_sqe* get_sqe ();
+    /**
+     * @brief one io_uring_enter - submits taken sqes (and ones left by failed submit), waits for wait_for cqes (with timeout when it is given)
+     * @return amount of submitted sqes, -errno on error (-ETIME - timeout)
+     */
+    int submit (unsigned int wait_for = 0, std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+    /**
+     * @return next cqe, nullptr when completion queue is empty (no syscall)
+     */
+    const io_uring_cqe* peek_cqe ();
+    void advance_cqe (); // frees cqe of peek_cqe
+
+private:
+    int m_fd = -1;
+
+    // submission queue
+    void*          m_submission_map      = nullptr;
+    size_t         m_submission_map_size = 0;
+    io_uring_sqe*  m_sqes                = nullptr;
+    size_t         m_sqes_size           = 0;
+    unsigned int*  m_submission_head     = nullptr;
+    unsigned int*  m_submission_tail     = nullptr;
+    unsigned int*  m_submission_array    = nullptr;
+    unsigned int   m_submission_mask     = 0;
+    unsigned int   m_submission_entries  = 0;
+    unsigned int   m_to_submit           = 0; // taken by get_sqe since last submit
+
+    // completion queue (is in the same map when kernel has IORING_FEAT_SINGLE_MMAP)
+    void*          m_completion_map      = nullptr;
+    size_t         m_completion_map_size = 0;
+    io_uring_cqe*  m_cqes                = nullptr;
+    unsigned int*  m_completion_head     = nullptr;
+    unsigned int*  m_completion_tail     = nullptr;
+    unsigned int   m_completion_mask     = 0;
+};
+
+/**
+ * Buffers given to kernel for receive (IORING_REGISTER_PBUF_RING) - kernel writes datagram straight to buffer,
+ * cqe has id of buffer, buffer is returned to ring by give_back when datagram is not used anymore
+ */
+class Uring_buffer_ring {
+public:
+    Uring_buffer_ring () = default;
+    ~Uring_buffer_ring ();
+    Uring_buffer_ring (const Uring_buffer_ring& ring) = delete;
+    Uring_buffer_ring& operator= (const Uring_buffer_ring& ring) = delete;
+
+public:
+    /**
+     * @brief allocates entries buffers of buffer_size (entries - power of 2) and registers them in uring
+     */
+    bool setup (Uring& uring, unsigned int entries, size_t buffer_size, uint16_t group);
+    void close ();
+
+    [[nodiscard]] std::span<uint8_t> buffer (uint16_t id);
+    void give_back (uint16_t id); // visible to kernel after publish
+    void publish ();
+
+private:
+    io_uring_buf_ring* m_ring        = nullptr;
+    size_t             m_ring_size   = 0;
+    uint8_t*           m_buffers     = nullptr;
+    size_t             m_buffer_size = 0;
+    unsigned int       m_entries     = 0;
+    uint16_t           m_tail        = 0;
+};
+
+#endif // URING_H
@@ -0,0 +1,111 @@
+#ifndef INPUT_RING_H
+#define INPUT_RING_H
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Inputs of one player waiting for tick - slot is chosen by id of message (id % capacity), memory is allocated once
+ * Window follows the newest id: inputs older than it are dropped (overflow), ids before last drain are late
+ * (position of client is newer already), ids don't have to be consecutive (GET_OTHER shares counter of client)
+ */
+
+enum class Input_result : uint8_t {
+    ACCEPTED  = 0,
+    DUPLICATE = 1, // the same id is waiting already
+    LATE      = 2, // id before last drain or outside of window (UINT64_MAX - end of window can't follow it) - dropped
+};
+
+struct Input_push {
+    Input_result result  = Input_result::ACCEPTED;
+    size_t       evicted = 0; // waiting inputs dropped because newer id moved window (overflow)
+};
+
+template <class T>
+class Input_ring {
+public:
+    /**
+     * @param window - ids kept at once, rounded up to power of 2
+     */
+    explicit Input_ring (size_t window): m_slots(std::bit_ceil(window < 2 ? size_t(2) : window)) {}
+
+public:
+    Input_push push (uint64_t id, const T& input);
+    /**
+     * @brief calls function(id, input) for waiting inputs in order of ids, ring is empty after it
+     */
+    template <class Function>
+    void drain (Function function);
+
+    [[nodiscard]] size_t size () const { return m_size; } // waiting inputs
+    [[nodiscard]] size_t capacity () const { return m_slots.size(); }
+
+private:
+    struct Slot {
+        uint64_t id      = 0;
+        bool     is_used = false;
+        T        input   = {};
+    };
+
+    [[nodiscard]] Slot& slot (uint64_t id) { return m_slots[id & (m_slots.size() - 1)]; }
+
+private:
+    std::vector<Slot> m_slots;
+    size_t            m_size  = 0;
+    uint64_t          m_begin = 0; // ids before it are late
+    uint64_t          m_end   = 0; // after newest id
+};
+
+// ===================================
+
+template <class T>
+Input_push Input_ring<T>::push (uint64_t id, const T& input) {
+    Input_push push;
+    if (id < m_begin or id == UINT64_MAX) {
+        push.result = Input_result::LATE;
+        return push;
+    }
+
+    // newer id - window moves, waiting inputs which are out of it are dropped
+    if (id >= m_end) {
+        uint64_t new_begin = (id + 1 > capacity()) ? id + 1 - capacity() : 0;
+        uint64_t from      = (m_end > capacity()) ? std::max(m_begin, m_end - capacity()) : m_begin;
+        for (uint64_t old = from; old < std::min(m_end, new_begin); ++old) {
+            Slot& evicted = slot(old);
+            if (not evicted.is_used or evicted.id != old) continue;
+            evicted.is_used = false;
+            --m_size;
+            ++push.evicted;
+        }
+        m_begin = std::max(m_begin, new_begin);
+        m_end   = id + 1;
+    }
+
+    Slot& target = slot(id);
+    if (target.is_used and target.id == id) {
+        push.result = Input_result::DUPLICATE;
+        return push;
+    }
+
+    target = Slot{.id=id, .is_used=true, .input=input};
+    ++m_size;
+    return push;
+}
+
+template <class T>
+template <class Function>
+void Input_ring<T>::drain (Function function) {
+    for (uint64_t id = m_begin; id < m_end and m_size != 0; ++id) {
+        Slot& waiting = slot(id);
+        if (not waiting.is_used or waiting.id != id) continue;
+        function(id, waiting.input);
+        waiting.is_used = false;
+        --m_size;
+    }
+    m_begin = m_end;
+}
+
+#endif // INPUT_RING_H
@@ -0,0 +1,152 @@
+#include "Player_states.h"
+#include <cmath>
+
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+    #define PLAYERS_HAS_AVX2_KERNEL 1
+    #define PLAYERS_INLINE [[gnu::always_inline]] inline // kernel is compiled again inside of avx2 function
+#else
+    #define PLAYERS_HAS_AVX2_KERNEL 0
+    #define PLAYERS_INLINE inline
+#endif
+
+// arrays of fields don't overlap - without it compiler checks every pair of them at run time (and gives up)
+#if defined(__clang__)
+    #define PLAYERS_INDEPENDENT_LOOP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+    #define PLAYERS_INDEPENDENT_LOOP _Pragma("GCC ivdep")
+#else
+    #define PLAYERS_INDEPENDENT_LOOP
+#endif
+
+void Player_fields::push_back (const Player_state& state) {
+    x.push_back(state.x);
+    y.push_back(state.y);
+    dx.push_back(state.dx);
+    dy.push_back(state.dy);
+    ddx.push_back(state.ddx);
+    ddy.push_back(state.ddy);
+    time.push_back(state.time);
+}
+
+void Player_fields::pop_back () {
+    x.pop_back();
+    y.pop_back();
+    dx.pop_back();
+    dy.pop_back();
+    ddx.pop_back();
+    ddy.pop_back();
+    time.pop_back();
+}
+
+void Player_fields::set (size_t index, const Player_state& state) {
+    x[index]    = state.x;
+    y[index]    = state.y;
+    dx[index]   = state.dx;
+    dy[index]   = state.dy;
+    ddx[index]  = state.ddx;
+    ddy[index]  = state.ddy;
+    time[index] = state.time;
+}
+
+Player_state Player_fields::get (size_t index) const {
+    return Player_state{.x=x[index], .y=y[index], .dx=dx[index], .dy=dy[index], .ddx=ddx[index], .ddy=ddy[index], .time=time[index]};
+}
+
+// ===================================
+
+void Player_states::push_back (const Player_state& state) {
+    m_current.push_back(state);
+    m_valid.push_back(state);
+    m_rejected.push_back(0);
+}
+
+void Player_states::erase (size_t index) {
+    size_t last = size() - 1;
+    if (index != last) {
+        m_current.set(index, m_current.get(last));
+        m_valid.set(index, m_valid.get(last));
+        m_rejected[index] = m_rejected[last];
+    }
+    m_current.pop_back();
+    m_valid.pop_back();
+    m_rejected.pop_back();
+}
+
+// one pass over arrays - no branches (integer masks instead of and), compiler makes lanes of it
+PLAYERS_INLINE size_t validate_kernel (Player_fields& current, Player_fields& valid, uint8_t* rejected,
+                                       size_t size, const Player_limits& limits) {
+    double*             x    = current.x.data();
+    double*             y    = current.y.data();
+    double*             dx   = current.dx.data();
+    double*             dy   = current.dy.data();
+    double*             ddx  = current.ddx.data();
+    double*             ddy  = current.ddy.data();
+    unsigned long long* time = current.time.data();
+
+    double*             valid_x    = valid.x.data();
+    double*             valid_y    = valid.y.data();
+    double*             valid_dx   = valid.dx.data();
+    double*             valid_dy   = valid.dy.data();
+    double*             valid_ddx  = valid.ddx.data();
+    double*             valid_ddy  = valid.ddy.data();
+    unsigned long long* valid_time = valid.time.data();
+
+    const double max_coordinate   = limits.max_coordinate; // locals - limits could alias arrays for compiler
+    const double max_speed        = limits.max_speed;
+    const double max_acceleration = limits.max_acceleration;
+
+    size_t amount = 0;
+    PLAYERS_INDEPENDENT_LOOP
+    for (size_t i = 0; i < size; ++i) {
+        // NaN fails every comparison - it is rejected too
+        uint64_t is_valid = uint64_t(std::fabs(x[i])   <= max_coordinate)   & uint64_t(std::fabs(y[i])   <= max_coordinate)
+                          & uint64_t(std::fabs(dx[i])  <= max_speed)        & uint64_t(std::fabs(dy[i])  <= max_speed)
+                          & uint64_t(std::fabs(ddx[i]) <= max_acceleration) & uint64_t(std::fabs(ddy[i]) <= max_acceleration)
+                          & uint64_t(time[i] >= valid_time[i]);
+
+        x[i]    = is_valid ? x[i]    : valid_x[i];
+        y[i]    = is_valid ? y[i]    : valid_y[i];
+        dx[i]   = is_valid ? dx[i]   : valid_dx[i];
+        dy[i]   = is_valid ? dy[i]   : valid_dy[i];
+        ddx[i]  = is_valid ? ddx[i]  : valid_ddx[i];
+        ddy[i]  = is_valid ? ddy[i]  : valid_ddy[i];
+        time[i] = is_valid ? time[i] : valid_time[i];
+
+        valid_x[i]    = x[i];
+        valid_y[i]    = y[i];
+        valid_dx[i]   = dx[i];
+        valid_dy[i]   = dy[i];
+        valid_ddx[i]  = ddx[i];
+        valid_ddy[i]  = ddy[i];
+        valid_time[i] = time[i];
+
+        rejected[i] = uint8_t(1 - is_valid);
+        amount     += 1 - is_valid;
+    }
+    return amount;
+}
+
+static size_t validate_default (Player_fields& current, Player_fields& valid, uint8_t* rejected, size_t size, const Player_limits& limits) {
+    return validate_kernel(current, valid, rejected, size, limits);
+}
+
+#if PLAYERS_HAS_AVX2_KERNEL
+
+__attribute__((target("avx2")))
+static size_t validate_avx2 (Player_fields& current, Player_fields& valid, uint8_t* rejected, size_t size, const Player_limits& limits) {
+    return validate_kernel(current, valid, rejected, size, limits);
+}
+
+static bool has_avx2 () {
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+}
+
+#endif
+
+size_t Player_states::validate (const Player_limits& limits) {
+#if PLAYERS_HAS_AVX2_KERNEL
+    if (has_avx2()) return validate_avx2(m_current, m_valid, m_rejected.data(), size(), limits);
+#endif
+    return validate_default(m_current, m_valid, m_rejected.data(), size(), limits);
+}
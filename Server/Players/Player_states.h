@@ -0,0 +1,92 @@
+#ifndef PLAYER_STATES_H
+#define PLAYER_STATES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/**
+ * Physics state of all players as struct of arrays - every field is own array aligned to cache line
+ * (index of Player_table), tick pass goes over all players field by field:
+ * AVX2 when cpu has it, otherwise instructions of build target (SSE2, NEON)
+ */
+
+// state of one player (reported by client)
+struct Player_state {
+    double x   = 0.0;
+    double y   = 0.0;
+    double dx  = 0.0;
+    double dy  = 0.0;
+    double ddx = 0.0;
+    double ddy = 0.0;
+    unsigned long long time = 0;
+};
+
+// bounds of valid state - speeds of client (Movable_entity) are 15 tiles/s run, 36 tiles/s fall, 40 tiles/s^2 run acceleration
+struct Player_limits {
+    double max_coordinate   = double(1 << 20); // px, absolute value
+    double max_speed        = 64.0 * 32;       // px/s, absolute value of dx and dy
+    double max_acceleration = 128.0 * 32;      // px/s^2, absolute value of ddx and ddy
+};
+
+template <class T>
+struct Cache_line_allocator {
+    using value_type = T;
+    static constexpr std::align_val_t ALIGNMENT = std::align_val_t(64);
+
+    Cache_line_allocator () = default;
+    template <class U> Cache_line_allocator (const Cache_line_allocator<U>&) {}
+
+    T*   allocate (size_t amount) { return static_cast<T*>(::operator new(amount * sizeof(T), ALIGNMENT)); }
+    void deallocate (T* pointer, size_t) { ::operator delete(pointer, ALIGNMENT); }
+
+    template <class U> bool operator== (const Cache_line_allocator<U>&) const { return true; }
+};
+
+template <class T>
+using Aligned_vector = std::vector<T, Cache_line_allocator<T>>;
+
+// one array for every field of Player_state
+struct Player_fields {
+    Aligned_vector<double>             x;
+    Aligned_vector<double>             y;
+    Aligned_vector<double>             dx;
+    Aligned_vector<double>             dy;
+    Aligned_vector<double>             ddx;
+    Aligned_vector<double>             ddy;
+    Aligned_vector<unsigned long long> time;
+
+    void               push_back (const Player_state& state);
+    void               pop_back ();
+    void               set (size_t index, const Player_state& state);
+    [[nodiscard]] Player_state get (size_t index) const;
+};
+
+class Player_states {
+public:
+    [[nodiscard]] size_t size () const { return m_current.x.size(); }
+
+    void push_back (const Player_state& state); // new player - state is valid
+    void erase (size_t index);                  // last player is moved to index (the same as Player_table)
+
+    /**
+     * @brief state reported by client, it is checked by next validate
+     */
+    void set (size_t index, const Player_state& state) { m_current.set(index, state); }
+    [[nodiscard]] Player_state get (size_t index) const { return m_current.get(index); }
+
+    /**
+     * @brief tick pass over all players - state which breaks limits (or goes back in time) is replaced by last valid one
+     * @return amount of rejected players, see is_rejected
+     */
+    size_t validate (const Player_limits& limits);
+    [[nodiscard]] bool is_rejected (size_t index) const { return m_rejected[index] != 0; }
+
+private:
+    Player_fields          m_current;
+    Player_fields          m_valid;    // state which passed last validate
+    Aligned_vector<uint8_t> m_rejected; // by last validate
+};
+
+#endif // PLAYER_STATES_H
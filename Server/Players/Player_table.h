@@ -0,0 +1,180 @@
+#ifndef PLAYER_TABLE_H
+#define PLAYER_TABLE_H
+
+#include "Socket.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/**
+ * Index of players - player is a dense index (0 .. size() - 1), data of players are kept by owner in arrays of this order
+ * Endpoint of packet finds its player by open addressing hash (linear probing), no allocation except growth of table
+ * Player handle (slot + generation) stays valid while player is in table - dense index changes when other player is erased
+ */
+
+struct Player_handle {
+    uint32_t slot       = ~uint32_t(0);
+    uint32_t generation = 0; // slot of erased player gets new generation - old handles don't find new player
+
+    [[nodiscard]] uint64_t value () const { return (uint64_t(generation) << 32) | slot; } // id of player for clients
+    bool operator== (const Player_handle& handle) const = default;
+};
+
+class Player_table {
+public:
+    explicit Player_table (size_t capacity = 64); // players without growth of table
+
+public:
+    /**
+     * @return dense index of player, std::nullopt when client isn't in table
+     */
+    [[nodiscard]] std::optional<size_t> find (Endpoint client) const;
+    [[nodiscard]] std::optional<size_t> find (Player_handle handle) const;
+    /**
+     * @brief client isn't in table, new player gets index size() - 1
+     */
+    size_t insert (Endpoint client);
+    /**
+     * @brief erased player is replaced by last one - owner moves its data of index size() (after erase) to returned index
+     * @return dense index of erased player, std::nullopt when client isn't in table
+     */
+    std::optional<size_t> erase (Endpoint client);
+
+    [[nodiscard]] size_t        size () const { return m_endpoints.size(); }
+    [[nodiscard]] bool          empty () const { return m_endpoints.empty(); }
+    [[nodiscard]] Endpoint      endpoint (size_t index) const { return m_endpoints[index]; }
+    [[nodiscard]] Player_handle handle (size_t index) const { return {.slot=m_dense_slots[index], .generation=m_slots[m_dense_slots[index]].generation}; }
+
+private:
+    static constexpr uint32_t NO_SLOT = ~uint32_t(0);
+
+    struct Slot {
+        uint32_t generation = 0;
+        uint32_t index      = NO_SLOT; // dense index, NO_SLOT - slot is free
+    };
+    struct Bucket {
+        uint64_t endpoint = 0;
+        uint32_t slot     = NO_SLOT; // NO_SLOT - empty bucket
+    };
+
+    [[nodiscard]] size_t home (uint64_t endpoint) const; // first bucket of endpoint
+    [[nodiscard]] std::optional<size_t> find_bucket (Endpoint client) const;
+    void place (uint64_t endpoint, uint32_t slot); // endpoint isn't in buckets, there is empty bucket
+    void grow ();
+
+private:
+    // dense - index of player
+    std::vector<Endpoint> m_endpoints;
+    std::vector<uint32_t> m_dense_slots;
+
+    std::vector<Slot>     m_slots;
+    std::vector<uint32_t> m_free_slots;
+    std::vector<Bucket>   m_buckets; // power of 2, at most half is used
+};
+
+// ===================================
+
+inline Player_table::Player_table (size_t capacity) {
+    m_endpoints.reserve(capacity);
+    m_dense_slots.reserve(capacity);
+    m_slots.reserve(capacity);
+    m_buckets.resize(std::bit_ceil(std::max(capacity, size_t(8)) * 2));
+}
+
+inline size_t Player_table::home (uint64_t endpoint) const {
+    // fibonacci hash - clients of one address differ only in low bits (port)
+    return size_t((endpoint * 0x9E3779B97F4A7C15ull) >> 32) & (m_buckets.size() - 1);
+}
+
+inline std::optional<size_t> Player_table::find_bucket (Endpoint client) const {
+    size_t mask = m_buckets.size() - 1;
+    for (size_t i = home(client.value());; i = (i + 1) & mask) {
+        const Bucket& bucket = m_buckets[i];
+        if (bucket.slot == NO_SLOT) return std::nullopt;
+        if (bucket.endpoint == client.value()) return i;
+    }
+}
+
+inline std::optional<size_t> Player_table::find (Endpoint client) const {
+    std::optional<size_t> bucket = find_bucket(client);
+    if (not bucket.has_value()) return std::nullopt;
+    return m_slots[m_buckets[bucket.value()].slot].index;
+}
+
+inline std::optional<size_t> Player_table::find (Player_handle handle) const {
+    if (handle.slot >= m_slots.size()) return std::nullopt;
+    const Slot& slot = m_slots[handle.slot];
+    if (slot.generation != handle.generation or slot.index == NO_SLOT) return std::nullopt;
+    return slot.index;
+}
+
+inline size_t Player_table::insert (Endpoint client) {
+    if ((size() + 1) * 2 > m_buckets.size()) grow();
+
+    uint32_t slot;
+    if (not m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else {
+        slot = uint32_t(m_slots.size());
+        m_slots.emplace_back();
+    }
+
+    size_t index = size();
+    m_slots[slot].index = uint32_t(index);
+    m_endpoints.push_back(client);
+    m_dense_slots.push_back(slot);
+    place(client.value(), slot);
+    return index;
+}
+
+inline std::optional<size_t> Player_table::erase (Endpoint client) {
+    std::optional<size_t> bucket = find_bucket(client);
+    if (not bucket.has_value()) return std::nullopt;
+
+    uint32_t slot  = m_buckets[bucket.value()].slot;
+    size_t   index = m_slots[slot].index;
+
+    // backward shift - following buckets of probe move to hole, no tombstones
+    size_t mask = m_buckets.size() - 1;
+    size_t hole = bucket.value();
+    for (size_t i = (hole + 1) & mask; m_buckets[i].slot != NO_SLOT; i = (i + 1) & mask) {
+        size_t ideal = home(m_buckets[i].endpoint);
+        if (((i - ideal) & mask) < ((i - hole) & mask)) continue; // its home is after hole - bucket can't move before it
+        m_buckets[hole] = m_buckets[i];
+        hole = i;
+    }
+    m_buckets[hole] = Bucket{};
+
+    // last player takes index of erased one
+    size_t last = size() - 1;
+    if (index != last) {
+        m_endpoints[index]   = m_endpoints[last];
+        m_dense_slots[index] = m_dense_slots[last];
+        m_slots[m_dense_slots[index]].index = uint32_t(index);
+    }
+    m_endpoints.pop_back();
+    m_dense_slots.pop_back();
+
+    m_slots[slot].index = NO_SLOT;
+    ++m_slots[slot].generation;
+    m_free_slots.push_back(slot);
+    return index;
+}
+
+inline void Player_table::place (uint64_t endpoint, uint32_t slot) {
+    size_t mask = m_buckets.size() - 1;
+    size_t i    = home(endpoint);
+    while (m_buckets[i].slot != NO_SLOT) i = (i + 1) & mask;
+    m_buckets[i] = Bucket{.endpoint=endpoint, .slot=slot};
+}
+
+inline void Player_table::grow () {
+    m_buckets.assign(m_buckets.size() * 2, Bucket{});
+    for (size_t index = 0; index < size(); ++index) place(m_endpoints[index].value(), m_dense_slots[index]);
+}
+
+#endif // PLAYER_TABLE_H
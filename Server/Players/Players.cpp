@@ -1,10 +1,11 @@
 #include "Players.h"
 #include "Network.h"
+#include <algorithm>
 #include <iostream>
 #include <ostream>
 #include <syncstream>
 
-Players::Players (Network& network) : m_network{network}, m_start_info{.x=0, .y=0, .dx=0, .dy=0, .ddx=0, .ddy=0, .time=0} {
+Players::Players (Network& network, Players_config config) : m_network{network}, m_config{config}, m_start_info{.x=0, .y=0, .dx=0, .dy=0, .ddx=0, .ddy=0, .time=0} {
     // TODO: add map
 }
 
@@ -13,112 +14,261 @@ Players::~Players () {
 }
 
 void Players::process_message (const Network_package& package) {
-    std::string client = package.ip + ":" + package.port;
+    Endpoint client = package.endpoint;
 
     switch (package.package.type) {
         case Package::Type::LOGIN:
             // std::osyncstream(std::cout) << "Server adding player: " << client << "\n";
-            add_player(client, package.ip, package.port);
+            add_player(client, package.package);
             break;
         case Package::Type::MESSAGE:
             // std::osyncstream(std::cout) << "Server getting info: " << client << "\n";
             add_player_info(client, package.package);
             break;
+        case Package::Type::COMPACT_MESSAGE:
+            add_compact_info(client, package.package);
+            break;
         case Package::Type::BREAK_SESSION:
             // std::osyncstream(std::cout) << "Server deleting player: " << client << "\n";
-            delete_player(client, package.ip, package.port);
+            delete_player(client);
             break;
         case Package::Type::GET_OTHER:
-            std::osyncstream(std::cout) << "Server getting others: " << client << "\n";
+            std::osyncstream(std::cout) << "Server getting others: " << client.to_string() << "\n";
             get_other_players(client, package);
             break;
+        case Package::Type::ACK_SNAPSHOT:
+            acknowledge_snapshot(client, package.package);
+            break;
         default:
             break;
     }
 }
 
 void Players::process_players () {
-    for (const auto& player : m_players) {
-        process_player_info(player.first);
+    for (size_t player = 0; player < m_players.size(); ++player) {
+        process_player_info(player);
     }
+
+    // physics check of all players at once
+    size_t rejected = m_states.validate(m_limits);
+    if (rejected != 0) std::osyncstream(std::cout) << "Server rejected state of " << rejected << " players" << "\n";
+
+    update_snapshot();
 }
 
-void Players::add_player (const std::string& client, const std::string& ip, const std::string& port) {
-    m_network.registered_acknowledge(ip, port);
+void Players::push_snapshot () {
+    if (not is_pushing()) return;
+    if (++m_push_tick < m_config.snapshot_interval) return;
+    m_push_tick = 0;
 
-    if (m_players.find(client) != m_players.end()) return;
+    // answer without request - id is number of snapshot, delta against acknowledged one when it is still kept
+    const World_snapshot& snapshot = m_snapshots.latest();
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        const World_snapshot* baseline = select_interest(i, snapshot, m_snapshots.find(m_players[i].snapshot_baseline), true);
+        // nobody near and nobody left - client's baseline stays valid (it is sent whole only when baseline isn't kept)
+        if (baseline != nullptr and m_interest.entries.empty() and m_interest.left.empty()) continue;
+        m_network.send_snapshot(m_table.endpoint(i), snapshot.id(), snapshot, m_interest, baseline);
+    }
+}
 
-    m_players[client] = Player{
-        .x=   m_start_info.x,     .y=  m_start_info.y,
-        .dx=  m_start_info.dx,    .dy= m_start_info.dy,
-        .ddx= m_start_info.ddx,   .ddy=m_start_info.ddy,
-        .time=m_start_info.time,
-        .ip=ip,                  .port=port,
-        .unprocessed={}
-    };
+bool Players::is_pushing () const {
+    return m_config.snapshot_interval != 0 and not m_table.empty();
+}
+
+void Players::add_player (Endpoint client, const Package& message) {
+    m_network.registered_acknowledge(client, message.compact.has_value(), m_config.snapshot_interval != 0);
+
+    // (repeated) login sets fec and compact state of session
+    if (message.fec.has_value()) m_network.enable_fec(client, message.fec.value());
+    else                         m_network.disable_fec(client);
+    if (message.compact.has_value()) m_network.enable_compact(client, message.compact.value());
+    else                             m_network.disable_compact(client);
+
+    std::optional<size_t> player = m_table.find(client);
+    if (not player.has_value()) {
+        player = m_table.insert(client);
+        m_states.push_back(m_start_info);
+        m_players.push_back(Player{.unprocessed=Input_ring<Player_info>(m_config.input_window)});
+        m_grid.push_back(m_start_info.x, m_start_info.y);
+    }
+    m_players[player.value()].compact = message.compact;
+}
+
+void Players::add_player_info (Endpoint client, const Package& message) {
+    std::optional<size_t> player = m_table.find(client);
+    if (not player.has_value()) return;
+    push_player_info(player.value(), message.id, {.x=message.x, .y=message.y, .dx=message.dx, .dy=message.dy, .ddx=message.ddx, .ddy=message.ddy, .time=message.time});
+}
+
+void Players::add_compact_info (Endpoint client, const Package& message) {
+    std::optional<size_t> player = m_table.find(client);
+    if (not player.has_value() or not m_players[player.value()].compact.has_value()) return;
+
+    Player_info info;
+    custom_utils::dequantize_state(m_players[player.value()].compact.value(), message.compact_state.value(), info);
+    push_player_info(player.value(), message.id, info);
+}
+
+void Players::push_player_info (size_t player_index, uint64_t id, const Player_info& info) {
+    Input_push push = m_players[player_index].unprocessed.push(id, info);
+
+    m_input_statistics.overflowed += push.evicted;
+    switch (push.result) {
+        case Input_result::ACCEPTED:  ++m_input_statistics.accepted;   break;
+        case Input_result::DUPLICATE: ++m_input_statistics.duplicates; break;
+        case Input_result::LATE:      ++m_input_statistics.late;       break;
+    }
 }
 
-void Players::add_player_info (const std::string& client, const Package& message) {
-    if (m_players.find(client) == m_players.end()) return;
-    m_players[client].unprocessed[message.id] = {.x=message.x, .y=message.y, .dx=message.dx, .dy=message.dy, .ddx=message.ddx, .ddy=message.ddy, .time=message.time};
+Input_statistics Players::input_statistics () const {
+    return m_input_statistics;
 }
 
-void Players::process_player_info (const std::string& client) {
-    std::osyncstream(std::cout) << "Server evaluating for: " << client << "\n";
-    auto find_player = m_players.find(client);
-    if (find_player == m_players.end()) return;
-    Player& player = find_player->second;
+void Players::process_player_info (size_t player_index) {
+    std::osyncstream(std::cout) << "Server evaluating for: " << m_table.endpoint(player_index).to_string() << "\n";
+    Player&      player = m_players[player_index];
+    Player_state state  = m_states.get(player_index);
 
-    id last_id;
-    for (auto it = player.unprocessed.begin(); it != player.unprocessed.end();) { // no ++it - using erase
-        // TODO: add physics check
-        player.x    = it->second.x;
-        player.y    = it->second.y;
-        player.dx   = it->second.dx;
-        player.dy   = it->second.dy;
-        player.time = it->second.time;
-        last_id     = it->first;
+    m_acknowledged.clear();
+    player.unprocessed.drain([&](uint64_t id, const Player_info& info) {
+        // physics check - Player_states::validate of tick
+        state.x    = info.x;
+        state.y    = info.y;
+        state.dx   = info.dx;
+        state.dy   = info.dy;
+        state.time = info.time;
 
         // std::osyncstream(std::cout) << "1111111: mew mew mew " << player.x << "\n";
-        m_network.acknowledge(player.ip, player.port, last_id);
+        m_acknowledged.push_back(id);
+    });
+    m_states.set(player_index, state);
+    m_network.acknowledge(m_table.endpoint(player_index), m_acknowledged);
+}
+
+void Players::delete_player (Endpoint client) {
+    // clients keep players until they log out - next deltas remove player
+    std::optional<size_t> index = m_table.find(client);
+    if (index.has_value()) m_departed.push_back({.snapshot=m_snapshot_id, .player=m_table.handle(index.value()).value()});
 
-        // ---
-        it = player.unprocessed.erase(it);
+    // last player takes index of deleted one
+    std::optional<size_t> player = m_table.erase(client);
+    if (player.has_value()) {
+        if (player.value() != m_players.size() - 1) m_players[player.value()] = std::move(m_players.back());
+        m_players.pop_back();
+        m_states.erase(player.value());
+        m_grid.erase(player.value());
     }
+    m_network.disable_fec(client);
+    m_network.disable_compact(client);
+    m_network.deleted_acknowledge(client);
+}
+
+void Players::get_other_players(Endpoint client, const Network_package& package) {
+    std::optional<size_t> player = m_table.find(client);
+    if (not player.has_value()) return;
+
+    // not only player (requester may be missing in snapshot - logged in during tick)
+    const World_snapshot& snapshot = m_snapshots.latest();
+    select_interest(player.value(), snapshot, nullptr, false);
+    if (m_interest.entries.empty()) return;
+
+    m_network.send_snapshot(client, package.package.id, snapshot, m_interest);
 }
 
-void Players::delete_player (const std::string& client, const std::string& ip, const std::string& port) {
-    m_players.erase(client);
-    m_network.deleted_acknowledge(ip, port);
+void Players::acknowledge_snapshot (Endpoint client, const Package& message) {
+    std::optional<size_t> player = m_table.find(client);
+    if (not player.has_value()) return;
+    if (message.id > m_snapshot_id) return; // not made yet
+
+    // last acknowledge wins - client resets baseline by 0 when it lost its snapshot
+    m_players[player.value()].snapshot_baseline = message.id;
+}
+
+void Players::update_snapshot () {
+    // serialized once - answers of clients only copy it
+    World_snapshot& snapshot = m_snapshots.next(++m_snapshot_id);
+    while (not m_departed.empty() and m_departed.front().snapshot + Snapshot_history::CAPACITY < m_snapshot_id) m_departed.pop_front();
+    for (size_t i = 0; i < m_players.size(); ++i) {
+        const Player_state player = m_states.get(i);
+        m_grid.move(i, player.x, player.y);
+        snapshot.add({
+            .x   =player.x,
+            .y   =player.y,
+            .dx  =player.dx,
+            .dy  =player.dy,
+            .ddx =player.ddx,
+            .ddy =player.ddy,
+            .id  =m_table.handle(i).value(), // stable while player is connected
+            .time=player.time,
+        });
+    }
 }
 
-void Players::get_other_players(const std::string& client, const Network_package& package) {
-    // make package
-    auto find_player = m_players.find(client);
-    if (find_player == m_players.end()) return;
+const World_snapshot* Players::select_interest (size_t player_index, const World_snapshot& snapshot, const World_snapshot* baseline, bool is_pushed) {
+    Player&  player    = m_players[player_index];
+    uint64_t player_id = m_table.handle(player_index).value();
+
+    m_interest.entries.clear();
+    m_interest.left.clear();
+    auto select = [&](size_t entry) {
+        if (snapshot.player(entry) != player_id) m_interest.entries.push_back({.entry=uint32_t(entry)});
+    };
 
-    // not only player
-    if (m_players.size() == 1) return;
+    bool is_far = m_config.far_interval != 0 and ++player.far_tick >= m_config.far_interval;
+    if (is_far) player.far_tick = 0;
 
+    if (is_far or m_config.interest_width <= 0 or m_config.interest_height <= 0) {
+        for (size_t entry = 0; entry < snapshot.size(); ++entry) select(entry);
+    } else {
+        // area around state of player - same as its entry of snapshot (new player - start state)
+        const Player_state state = m_states.get(player_index);
+        double left   = state.x - m_config.interest_width / 2;
+        double right  = state.x + m_config.interest_width / 2;
+        double top    = state.y - m_config.interest_height / 2;
+        double bottom = state.y + m_config.interest_height / 2;
 
-    // add data about other
-    std::vector<Answer::Other> other;
-    other.reserve(m_players.size() - 1);
+        m_grid.for_each(left, top, right, bottom, [&](size_t index) {
+            // grid follows m_table - players logged in after snapshot aren't in it
+            std::optional<size_t> entry = snapshot.find(m_table.handle(index).value(), index);
+            if (not entry.has_value()) return;
 
-    unsigned long long pseudo_id = 0; // TODO: make better id system
-    for (const auto& other_player : m_players) {
-        if (other_player.first == client) continue;
-        other.push_back({
-            .x   =other_player.second.x,
-            .y   =other_player.second.y,
-            .dx  =other_player.second.dx,
-            .dy  =other_player.second.dy,
-            .ddx =other_player.second.ddx,
-            .ddy =other_player.second.ddy,
-            .id  =pseudo_id++,
-            .time=other_player.second.time,
+            const Answer::Other& other = snapshot.other(entry.value());
+            if (other.x < left or other.x > right or other.y < top or other.y > bottom) return;
+            select(entry.value());
         });
+        // order of snapshot - neighbouring entries are copied at once
+        std::sort(m_interest.entries.begin(), m_interest.entries.end(), [](const auto& a, const auto& b) { return a.entry < b.entry; });
+    }
+
+    m_selected.clear();
+    for (const Snapshot_interest::Entry& entry : m_interest.entries) m_selected.push_back(snapshot.player(entry.entry));
+    std::sort(m_selected.begin(), m_selected.end());
+
+    // client has values of baseline only for players sent in it - others are sent whole,
+    // players out of area (after far snapshot) stay at client, only ones logged out since baseline are removed
+    const Sent_players* sent = nullptr;
+    if (baseline != nullptr) {
+        const Sent_players& players = player.sent[baseline->id() % Snapshot_history::CAPACITY];
+        if (players.snapshot == baseline->id()) sent = &players;
+        else                                    baseline = nullptr;
+    }
+    if (sent != nullptr) {
+        for (Snapshot_interest::Entry& entry : m_interest.entries) {
+            uint64_t id = snapshot.player(entry.entry);
+            if (not std::binary_search(sent->players.begin(), sent->players.end(), id)) continue;
+
+            std::optional<size_t> old = baseline->find(id, entry.entry);
+            if (old.has_value()) entry.baseline = uint32_t(old.value());
+        }
+        for (const Departed_player& departed : m_departed) {
+            if (departed.snapshot >= baseline->id()) m_interest.left.push_back(departed.player);
+        }
     }
 
-    m_network.send_info_of_other(package.ip, package.port, package.package.id, other);
-}
\ No newline at end of file
+    if (is_pushed) {
+        Sent_players& players = player.sent[snapshot.id() % Snapshot_history::CAPACITY];
+        players.snapshot = snapshot.id();
+        players.players.assign(m_selected.begin(), m_selected.end());
+    }
+    return baseline;
+}
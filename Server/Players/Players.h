@@ -1,56 +1,111 @@
 #ifndef PLAYERS_H
 #define PLAYERS_H
 
-#include <map>
-#include <string>
+#include <array>
+#include <deque>
+#include <optional>
+#include <vector>
+#include "Input_ring.h"
 #include "Network.h"
+#include "Player_states.h"
+#include "Player_table.h"
+#include "Spatial_grid.h"
+
+struct Players_config {
+    // ids of messages kept for one player between ticks (GET_OTHER uses ids too), older ones are dropped
+    size_t input_window = 64;
+    // ticks between world snapshots pushed to logged in players, 0 - no push (snapshots are only answers of GET_OTHER)
+    size_t snapshot_interval = 1;
+    // area around player (pixels) - its snapshots have only players inside it, 0 - all players
+    // camera of client (42 x 24 tiles) and 8 tiles around it (drawn border and lag of camera)
+    double interest_width  = (42 + 2 * 8) * 32;
+    double interest_height = (24 + 2 * 8) * 32;
+    // snapshots of one player between ones with all players (far players are updated rarely), 0 - never
+    size_t far_interval = 40;
+};
+
+// results of Input_ring::push since start
+struct Input_statistics {
+    uint64_t accepted   = 0;
+    uint64_t duplicates = 0;
+    uint64_t late       = 0;
+    uint64_t overflowed = 0; // dropped because window moved
+};
 
 class Players {
 public:
     using id = unsigned long long;
 public:
-    Players (Network& network);
+    explicit Players (Network& network, Players_config config = {});
     ~Players ();
     Players (const Players& players) = delete;
 
 public:
     void process_message (const Network_package& package); // process from network
     void process_players ();                               // process from buffer
+    void push_snapshot ();                                 // after process_players - snapshot of tick to every player
+    /**
+     * @return true when logged in players wait for pushed snapshots - tick has to run without messages
+     */
+    [[nodiscard]] bool is_pushing () const;
+    [[nodiscard]] Input_statistics input_statistics () const;
 
 private:
-    struct Player_info {
-        double x;
-        double y;
-        double dx;
-        double dy;
-        double ddx;
-        double ddy;
-        unsigned long long time;
+    using Player_info = Player_state;
+
+    // players of snapshot pushed to one client
+    struct Sent_players {
+        uint64_t snapshot = 0;
+        std::vector<uint64_t> players; // sorted ids
+    };
+
+    // logged out player - deltas against snapshots up to it remove player
+    struct Departed_player {
+        uint64_t snapshot = 0; // latest snapshot when player logged out
+        uint64_t player   = 0;
     };
 
+    // data of player outside of physics (m_states)
     struct Player {
-        double x;
-        double y;
-        double dx;
-        double dy;
-        double ddx;
-        double ddy;
-        unsigned long long time;
-        std::string ip; // TODO: add constructor and make ip and port const
-        std::string port;
-        std::map<id, Player_info> unprocessed;
+        Input_ring<Player_info> unprocessed;
+        uint64_t snapshot_baseline = 0; // last snapshot acknowledged by client - pushed deltas are against it (0 - none)
+        std::optional<custom_utils::Compact_config> compact = std::nullopt; // quantization of COMPACT_MESSAGE
+        size_t far_tick = 0; // snapshots since last one with all players
+        std::array<Sent_players, Snapshot_history::CAPACITY> sent = {}; // index - id of snapshot % CAPACITY, deltas know what client has
     };
 
 private:
-    void add_player          (const std::string& client, const std::string& ip, const std::string& port); // done so to reduce string processing
-    void add_player_info     (const std::string& client, const Package& message);
-    void process_player_info (const std::string& client);
-    void delete_player       (const std::string& client, const std::string& ip, const std::string& port);
-    void get_other_players   (const std::string& client, const Network_package& package);
+    void add_player          (Endpoint client, const Package& message);
+    void add_player_info     (Endpoint client, const Package& message);
+    void add_compact_info    (Endpoint client, const Package& message);
+    void push_player_info    (size_t player_index, uint64_t id, const Player_info& info); // index of m_table
+    void process_player_info (size_t player_index); // index of m_table
+    void delete_player       (Endpoint client);
+    void get_other_players   (Endpoint client, const Network_package& package);
+    void acknowledge_snapshot (Endpoint client, const Package& message);
+    void update_snapshot     (); // after physics check of tick
+    /**
+     * @brief m_interest - players of snapshot for player (area of interest or all of them), is_pushed - players are kept as possible baseline
+     * @return baseline deltas can use (nullptr - snapshot is sent whole)
+     */
+    const World_snapshot* select_interest (size_t player_index, const World_snapshot& snapshot, const World_snapshot* baseline, bool is_pushed);
 private:
     Network& m_network;
-    std::map<std::string, Player> m_players;
+    Players_config m_config;
+    Player_table m_table;
+    Player_states m_states;        // index of m_table
+    std::vector<Player> m_players; // index of m_table
     const Player_info m_start_info;
+    const Player_limits m_limits;
+    Input_statistics m_input_statistics;
+    std::vector<uint64_t> m_acknowledged; // ids of one player in tick - one acknowledge call, every id is still sent on its own
+    Snapshot_history m_snapshots;         // players of last ticks - latest one answers GET_OTHER of all clients, older ones are baselines
+    uint64_t m_snapshot_id = 0;           // id of pushed answers - number of snapshot
+    size_t   m_push_tick   = 0;           // ticks since last pushed snapshot
+    Spatial_grid m_grid;                  // index of m_table - positions of last snapshot
+    Snapshot_interest m_interest;         // players of one answer
+    std::vector<uint64_t> m_selected;     // sorted ids of m_interest
+    std::deque<Departed_player> m_departed; // players logged out during kept snapshots (Snapshot_history)
 };
 
 #endif // PLAYERS_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Uniform grid of positions (pixels) - member is a dense index (0 .. size() - 1) in order of owner (same as Player_table)
+ * Only occupied cells are kept (hash of cell), member moves between cells only when its cell changes
+ * Area query visits cells overlapping area - cost depends on players near area, not on all players
+ */
+class Spatial_grid {
+public:
+    explicit Spatial_grid (double cell_size = 8 * 32); // 8 tiles
+
+public:
+    /**
+     * @brief new member gets index size()
+     */
+    void push_back (double x, double y);
+    /**
+     * @brief erased member is replaced by last one (as Player_table::erase)
+     */
+    void erase (size_t index);
+    void move  (size_t index, double x, double y);
+    /**
+     * @brief function (size_t index) of every member in cells overlapping area - members near its border may be outside of it
+     */
+    template <class Function>
+    void for_each (double left, double top, double right, double bottom, Function&& function) const;
+
+    [[nodiscard]] size_t size () const { return m_members.size(); }
+
+private:
+    struct Member {
+        uint64_t cell;
+        uint32_t position; // in vector of cell
+    };
+
+    [[nodiscard]] int32_t  coordinate (double value) const; // cell of axis, clamped (nan too)
+    [[nodiscard]] uint64_t cell (int32_t column, int32_t row) const { return uint64_t(uint32_t(column)) << 32 | uint32_t(row); }
+    void insert (size_t index, uint64_t cell);
+    void remove (size_t index); // member stays in m_members
+
+private:
+    double m_cell_size;
+    std::vector<Member> m_members;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells; // indexes of members
+};
+
+// ===================================
+
+inline Spatial_grid::Spatial_grid (double cell_size) : m_cell_size{cell_size} {}
+
+inline int32_t Spatial_grid::coordinate (double value) const {
+    double cell = std::floor(value / m_cell_size);
+    if (not (cell >= double(std::numeric_limits<int32_t>::min()))) return std::numeric_limits<int32_t>::min();
+    return int32_t(std::min(cell, double(std::numeric_limits<int32_t>::max())));
+}
+
+inline void Spatial_grid::insert (size_t index, uint64_t cell) {
+    std::vector<uint32_t>& members = m_cells[cell];
+    m_members[index] = Member{.cell=cell, .position=uint32_t(members.size())};
+    members.push_back(uint32_t(index));
+}
+
+inline void Spatial_grid::remove (size_t index) {
+    auto cell = m_cells.find(m_members[index].cell);
+    std::vector<uint32_t>& members = cell->second;
+
+    // last member of cell takes position of removed one
+    uint32_t position = m_members[index].position;
+    members[position] = members.back();
+    m_members[members[position]].position = position;
+    members.pop_back();
+    if (members.empty()) m_cells.erase(cell);
+}
+
+inline void Spatial_grid::push_back (double x, double y) {
+    m_members.emplace_back();
+    insert(m_members.size() - 1, cell(coordinate(x), coordinate(y)));
+}
+
+inline void Spatial_grid::erase (size_t index) {
+    remove(index);
+
+    // last member takes index of erased one
+    size_t last = m_members.size() - 1;
+    if (index != last) {
+        m_members[index] = m_members[last];
+        m_cells.find(m_members[index].cell)->second[m_members[index].position] = uint32_t(index);
+    }
+    m_members.pop_back();
+}
+
+inline void Spatial_grid::move (size_t index, double x, double y) {
+    uint64_t next = cell(coordinate(x), coordinate(y));
+    if (next == m_members[index].cell) return;
+
+    remove(index);
+    insert(index, next);
+}
+
+template <class Function>
+void Spatial_grid::for_each (double left, double top, double right, double bottom, Function&& function) const {
+    int32_t first_column = coordinate(left),  last_column = coordinate(right);
+    int32_t first_row    = coordinate(top),   last_row    = coordinate(bottom);
+    if (first_column > last_column or first_row > last_row) return;
+
+    uint64_t area = uint64_t(int64_t(last_column) - first_column + 1) * uint64_t(int64_t(last_row) - first_row + 1);
+    if (area > m_cells.size()) {
+        // area is larger than occupied part of map - occupied cells are checked instead
+        for (const auto& [key, members] : m_cells) {
+            int32_t column = int32_t(uint32_t(key >> 32)), row = int32_t(uint32_t(key));
+            if (column < first_column or column > last_column or row < first_row or row > last_row) continue;
+            for (uint32_t index : members) function(size_t(index));
+        }
+        return;
+    }
+
+    for (int64_t column = first_column; column <= last_column; ++column) {
+        for (int64_t row = first_row; row <= last_row; ++row) {
+            auto cell = m_cells.find(this->cell(int32_t(column), int32_t(row)));
+            if (cell == m_cells.end()) continue;
+            for (uint32_t index : cell->second) function(size_t(index));
+        }
+    }
+}
+
+#endif // SPATIAL_GRID_H
@@ -28,6 +28,26 @@ def define_dll_libraries():
     error_repair_lib.decode_package_c_wrapped.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t, ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)), ctypes.POINTER(ctypes.c_size_t)]
     error_repair_lib.decode_package_c_wrapped.restype  = ctypes.c_bool
 
+    # extern "C" size_t encoded_package_size_c_wrapped (size_t size);
+    error_repair_lib.encoded_package_size_c_wrapped.argtypes = [ctypes.c_size_t]
+    error_repair_lib.encoded_package_size_c_wrapped.restype  = ctypes.c_size_t
+
+    # extern "C" bool encode_package_into_c_wrapped (const uint8_t* ptr_data, size_t size, uint8_t* result, size_t result_capacity, size_t* result_size);
+    error_repair_lib.encode_package_into_c_wrapped.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t, ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t)]
+    error_repair_lib.encode_package_into_c_wrapped.restype  = ctypes.c_bool
+
+    # extern "C" bool decode_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, size_t* result_size);
+    error_repair_lib.decode_package_in_place_c_wrapped.argtypes = [ctypes.POINTER(ctypes.c_uint8), ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t)]
+    error_repair_lib.decode_package_in_place_c_wrapped.restype  = ctypes.c_bool
+
+    # extern "C" size_t encode_packages_batch_c_wrapped (const uint8_t* const* ptr_packages, const size_t* sizes, size_t count, uint8_t* const* results, const size_t* result_capacities, size_t* result_sizes);
+    error_repair_lib.encode_packages_batch_c_wrapped.argtypes = [ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)), ctypes.POINTER(ctypes.c_size_t), ctypes.c_size_t, ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)), ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_size_t)]
+    error_repair_lib.encode_packages_batch_c_wrapped.restype  = ctypes.c_size_t
+
+    # extern "C" size_t decode_packages_batch_c_wrapped (uint8_t* const* ptr_packages, const size_t* sizes, size_t count, size_t* result_sizes, bool* is_decoded);
+    error_repair_lib.decode_packages_batch_c_wrapped.argtypes = [ctypes.POINTER(ctypes.POINTER(ctypes.c_uint8)), ctypes.POINTER(ctypes.c_size_t), ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t), ctypes.POINTER(ctypes.c_bool)]
+    error_repair_lib.decode_packages_batch_c_wrapped.restype  = ctypes.c_size_t
+
 
 define_dll_libraries()
 
@@ -38,39 +58,63 @@ def define_dll_libraries():
 
 # ---------------------------------------------------------
 
-# extern "C" bool encode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size);
+# extern "C" bool encode_package_into_c_wrapped (const uint8_t* ptr_data, size_t size, uint8_t* result, size_t result_capacity, size_t* result_size);
 def encode_data(data: bytes) -> bytes | None:
-    data = (ctypes.c_uint8 * len(data))(*data)
-    size = ctypes.c_size_t(len(data))
+    capacity = error_repair_lib.encoded_package_size_c_wrapped(len(data))
+    if capacity == 0:
+        return None
 
-    result      = ctypes.POINTER(ctypes.c_uint8)()
+    data        = (ctypes.c_uint8 * len(data))(*data)
+    result      = (ctypes.c_uint8 * capacity)()
     result_size = ctypes.c_size_t()
 
-    is_ok: ctypes.c_bool = error_repair_lib.encode_package_c_wrapped(data, size, ctypes.byref(result), ctypes.byref(result_size))
+    is_ok: ctypes.c_bool = error_repair_lib.encode_package_into_c_wrapped(data, len(data), result, capacity, ctypes.byref(result_size))
     if not is_ok:
         return None
 
-    data = bytearray(result[:result_size.value])
-    error_repair_lib.free_c_wrapped(ctypes.cast(result, ctypes.c_void_p))
-    return bytes(data)
+    return bytes(result[:result_size.value])
 
 
-# extern "C" bool decode_package_c_wrapped (uint8_t* ptr_data, size_t size, uint8_t** result, size_t* result_size);
+# extern "C" bool decode_package_in_place_c_wrapped (uint8_t* ptr_data, size_t size, size_t* result_size);
 def decode_data(data: bytes) -> bytes | None:
-    data = (ctypes.c_uint8 * len(data))(*data)
-    size = ctypes.c_size_t(len(data))
-
-    result      = ctypes.POINTER(ctypes.c_uint8)()
+    data        = (ctypes.c_uint8 * len(data)).from_buffer_copy(data)
     result_size = ctypes.c_size_t()
 
-    is_ok: ctypes.c_bool = error_repair_lib.decode_package_c_wrapped(data, size, ctypes.byref(result), ctypes.byref(result_size))
+    is_ok: ctypes.c_bool = error_repair_lib.decode_package_in_place_c_wrapped(data, len(data), ctypes.byref(result_size))
     if not is_ok:
         return None
 
-    data = bytearray(result[:result_size.value])
-    error_repair_lib.free_c_wrapped(ctypes.cast(result, ctypes.c_void_p))
+    return bytes(data[:result_size.value])
+
+
+# extern "C" size_t encode_packages_batch_c_wrapped (const uint8_t* const* ptr_packages, const size_t* sizes, size_t count, uint8_t* const* results, const size_t* result_capacities, size_t* result_sizes);
+def encode_data_batch(datas: list[bytes]) -> list[bytes | None]:
+    count      = len(datas)
+    packages   = [(ctypes.c_uint8 * len(data))(*data) for data in datas]
+    capacities = [error_repair_lib.encoded_package_size_c_wrapped(len(data)) for data in datas]
+    results    = [(ctypes.c_uint8 * capacity)() for capacity in capacities]
+
+    ptr_packages = (ctypes.POINTER(ctypes.c_uint8) * count)(*[ctypes.cast(x, ctypes.POINTER(ctypes.c_uint8)) for x in packages])
+    ptr_results  = (ctypes.POINTER(ctypes.c_uint8) * count)(*[ctypes.cast(x, ctypes.POINTER(ctypes.c_uint8)) for x in results])
+    sizes        = (ctypes.c_size_t * count)(*[len(data) for data in datas])
+    result_sizes = (ctypes.c_size_t * count)()
+
+    error_repair_lib.encode_packages_batch_c_wrapped(ptr_packages, sizes, count, ptr_results, (ctypes.c_size_t * count)(*capacities), result_sizes)
+    return [bytes(result[:size]) if size != 0 else None for result, size in zip(results, result_sizes)]
+
+
+# extern "C" size_t decode_packages_batch_c_wrapped (uint8_t* const* ptr_packages, const size_t* sizes, size_t count, size_t* result_sizes, bool* is_decoded);
+def decode_data_batch(datas: list[bytes]) -> list[bytes | None]:
+    count    = len(datas)
+    packages = [(ctypes.c_uint8 * len(data)).from_buffer_copy(data) for data in datas]
+
+    ptr_packages = (ctypes.POINTER(ctypes.c_uint8) * count)(*[ctypes.cast(x, ctypes.POINTER(ctypes.c_uint8)) for x in packages])
+    sizes        = (ctypes.c_size_t * count)(*[len(data) for data in datas])
+    result_sizes = (ctypes.c_size_t * count)()
+    is_decoded   = (ctypes.c_bool * count)()
 
-    return bytes(data)
+    error_repair_lib.decode_packages_batch_c_wrapped(ptr_packages, sizes, count, result_sizes, is_decoded)
+    return [bytes(package[:size]) if is_ok else None for package, size, is_ok in zip(packages, result_sizes, is_decoded)]
 
 # ------------------------------------------
 
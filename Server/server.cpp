@@ -1,10 +1,12 @@
 #include <chrono>
-#include <winsock2.h>
-#include <Ws2tcpip.h>
 #include "Network.h"
 #include "Players.h"
 #include "Players/Players.h"
+#include <cstdlib>
+#include <optional>
+#include <string_view>
 #include <thread>
+#include <vector>
 #include <syncstream>
 #include <iostream>
 
@@ -36,12 +38,12 @@ void thread_reader_main (Network& network, Players& players) {
     const int MAX_PACKAGES_PER_TIME = 10;
     const std::chrono::microseconds PROCESS_INTERVAL = std::chrono::milliseconds(25); // Interval to process messages
     auto next_process_time = std::chrono::steady_clock::now() + PROCESS_INTERVAL;
+    const std::chrono::seconds STATISTICS_INTERVAL = std::chrono::seconds(10);
+    auto next_statistics_time = std::chrono::steady_clock::now() + STATISTICS_INTERVAL;
 
     while (network.is_server_running()) {
-        // try to get message (spinlock)
-        while (not network.has_message()) {
-            std::this_thread::yield();
-        }
+        // sleep until message is received (receive thread wakes reader) - players waiting for pushed snapshots keep tick running
+        if (not players.is_pushing() and not network.wait_message()) continue; // server was stopped
 
         // wait for min time to process messages
         std::this_thread::sleep_until(next_process_time);
@@ -54,24 +56,103 @@ void thread_reader_main (Network& network, Players& players) {
                 continue;
             }
             players.process_message(*package);
-            // std::osyncstream(std::cout) << "Client: " << package->ip << ":" << package->port << "\n"
+            // std::osyncstream(std::cout) << "Client: " << package->endpoint.to_string() << "\n"
             //                             << "Type: " << int(package->package.type) << "\n" << std::flush;
         }
 
         // process messages
         std::osyncstream(std::cout) << "Processing player packages..." << '\n';
         players.process_players();
+        players.push_snapshot(); // right after tick - snapshot isn't older than one tick
+
+        // answers of tick (batched network)
+        network.flush_answers();
+
+        if (std::chrono::steady_clock::now() >= next_statistics_time) {
+            Socket_statistics statistics = network.io_statistics();
+            std::osyncstream(std::cout) << "Socket: " << statistics.received_datagrams << " datagrams received by " << statistics.receive_calls << " calls, "
+                                        << statistics.sent_datagrams << " sent by " << statistics.send_calls << " calls, "
+                                        << statistics.wait_calls << " waits" << '\n';
+            Packet_ring_statistics queue = network.queue_statistics();
+            std::osyncstream(std::cout) << "Queue: " << queue.pushed << " datagrams queued, " << queue.dropped << " dropped, "
+                                        << queue.full << " times full" << '\n';
+            Packet_pool_statistics pool = network.pool_statistics();
+            std::osyncstream(std::cout) << "Packets: " << pool.in_use << " of " << pool.capacity << " buffers in use, high water " << pool.high_water << '\n';
+            Input_statistics inputs = players.input_statistics();
+            std::osyncstream(std::cout) << "Inputs: " << inputs.accepted << " accepted, " << inputs.duplicates << " duplicates, "
+                                        << inputs.late << " late, " << inputs.overflowed << " overflowed" << '\n';
+            next_statistics_time = std::chrono::steady_clock::now() + STATISTICS_INTERVAL;
+        }
     }
 
 }
 
-int main () {
-    Network network;
-    Players players(network);
-    std::thread t1(&Network::socket_main, &network);
+// --io-batch <n>       - datagrams per receive/send syscall
+// --receive-shards <k> - sockets (and receive threads) on server port
+// --backend <name>     - epoll or io_uring
+// --decode-workers <w> - threads decoding datagrams before reader (0 - reader decodes them)
+// --input-window <n>   - ids of messages kept for one player between ticks
+// --snapshot-interval <n> - ticks between snapshots pushed to players (0 - clients ask for them by GET_OTHER)
+// --interest-width <px>, --interest-height <px> - area around player of its snapshots (0 - all players)
+// --far-interval <n>   - snapshots of one player between ones with all players (0 - never)
+struct Server_config {
+    Network_config network;
+    Players_config players;
+};
+
+static std::optional<Server_config> parse_arguments (int argc, char** argv) {
+    Server_config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view argument = argv[i];
+        if (argument == "--io-batch" and i + 1 < argc) {
+            config.network.io_batch = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--receive-shards" and i + 1 < argc) {
+            config.network.receive_shards = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--decode-workers" and i + 1 < argc) {
+            config.network.decode_workers = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--input-window" and i + 1 < argc) {
+            config.players.input_window = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--snapshot-interval" and i + 1 < argc) {
+            config.players.snapshot_interval = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--interest-width" and i + 1 < argc) {
+            config.players.interest_width = std::strtod(argv[++i], nullptr);
+        } else if (argument == "--interest-height" and i + 1 < argc) {
+            config.players.interest_height = std::strtod(argv[++i], nullptr);
+        } else if (argument == "--far-interval" and i + 1 < argc) {
+            config.players.far_interval = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--backend" and i + 1 < argc) {
+            std::string_view backend = argv[++i];
+            if      (backend == "epoll")    config.network.backend = Socket_backend::EPOLL;
+            else if (backend == "io_uring") config.network.backend = Socket_backend::IO_URING;
+            else return std::nullopt;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return config;
+}
+
+int main (int argc, char** argv) {
+    std::optional<Server_config> config = parse_arguments(argc, argv);
+    if (not config.has_value()) {
+        std::osyncstream(std::cerr) << "Usage: " << argv[0] << " [--io-batch <datagrams per syscall>] [--receive-shards <sockets>] [--backend epoll|io_uring] [--decode-workers <threads>] [--input-window <ids>] [--snapshot-interval <ticks>] [--interest-width <px>] [--interest-height <px>] [--far-interval <snapshots>]" << '\n';
+        return 1;
+    }
+
+    Network network(config->network);
+    Players players(network, config->players);
+    std::vector<std::thread> receive_threads;
+    for (size_t shard = 0; shard < network.receive_shards(); ++shard) {
+        receive_threads.emplace_back(&Network::socket_main, &network, shard);
+    }
+    std::vector<std::thread> decode_threads;
+    for (size_t worker = 0; worker < network.decode_workers(); ++worker) {
+        decode_threads.emplace_back(&Network::decode_main, &network, worker);
+    }
     std::thread t2(&thread_reader_main, std::ref(network), std::ref(players));
     // network.socket_main();
-    t1.join();
+    for (std::thread& thread : receive_threads) thread.join();
+    for (std::thread& thread : decode_threads) thread.join();
     t2.join();
     return 0;
 }
\ No newline at end of file
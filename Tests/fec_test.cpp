@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <packet_fec.h>
+#include <vector>
+
+/**
+ * Fec_encoder and Fec_decoder of one session - package lost in group is restored by parity:
+ *     full group of k packages
+ *     group flushed after fewer packages (sparse sender), parity before or after data datagrams
+ */
+
+using Datagrams = std::vector<std::vector<uint8_t>>;
+
+static bool check (bool condition, const char* message) {
+    if (not condition) std::cerr << "FAILED: " << message << '\n';
+    return condition;
+}
+
+static std::vector<uint8_t> make_package (uint8_t seed, size_t size) {
+    std::vector<uint8_t> package(size);
+    for (size_t i = 0; i < size; ++i) package[i] = uint8_t(seed * 31 + i);
+    return package;
+}
+
+/**
+ * @brief packages of group are pushed (and flushed when there are less than k of them), datagram lost is dropped before decoder
+ * @return package of lost datagram is restored, others are returned once
+ */
+static bool restores (custom_utils::Fec_config config, size_t packages, size_t lost, bool is_parity_first) {
+    custom_utils::Fec_encoder encoder(config);
+    std::vector<std::vector<uint8_t>> sent;
+    Datagrams data;
+    Datagrams parity;
+    for (size_t i = 0; i < packages; ++i) {
+        sent.push_back(make_package(uint8_t(i), 10 + 7 * i));
+        std::optional<Datagrams> datagrams = encoder.push(sent.back());
+        if (not datagrams.has_value()) return false;
+
+        data.push_back(datagrams->front());
+        parity.insert(parity.end(), datagrams->begin() + 1, datagrams->end());
+    }
+    Datagrams flushed = encoder.flush();
+    parity.insert(parity.end(), flushed.begin(), flushed.end());
+    if (parity.size() != config.parity_shards) return false;
+
+    custom_utils::Fec_decoder decoder;
+    std::vector<std::vector<uint8_t>> received;
+    auto receive = [&](const Datagrams& datagrams, bool is_data) {
+        for (size_t i = 0; i < datagrams.size(); ++i) {
+            if (is_data and i == lost) continue;
+            for (auto& package : decoder.push(datagrams[i])) received.push_back(package);
+        }
+    };
+    if (is_parity_first) receive(parity, false);
+    receive(data, true);
+    if (not is_parity_first) receive(parity, false);
+
+    if (received.size() != sent.size()) return false;
+    for (const auto& package : sent) {
+        if (std::count(received.begin(), received.end(), package) != 1) return false;
+    }
+    return true;
+}
+
+int main () {
+    const custom_utils::Fec_config xor_config{.scheme=custom_utils::Fec_scheme::XOR, .data_shards=4, .parity_shards=1};
+    const custom_utils::Fec_config reed_solomon{.scheme=custom_utils::Fec_scheme::REED_SOLOMON, .data_shards=4, .parity_shards=2};
+
+    bool is_ok = true;
+    is_ok &= check(restores(xor_config, 4, 2, false), "xor - full group");
+    is_ok &= check(restores(xor_config, 2, 0, false), "xor - flushed group");
+    is_ok &= check(restores(xor_config, 3, 1, true), "xor - flushed group, parity first");
+    is_ok &= check(restores(reed_solomon, 4, 3, false), "reed solomon - full group");
+    is_ok &= check(restores(reed_solomon, 1, 0, false), "reed solomon - flushed group of one package");
+    is_ok &= check(restores(reed_solomon, 3, 2, true), "reed solomon - flushed group, parity first");
+
+    // nothing to flush - no parity
+    custom_utils::Fec_encoder encoder(xor_config);
+    is_ok &= check(encoder.flush().empty(), "empty group isn't flushed");
+    encoder.push(make_package(1, 8));
+    is_ok &= check(encoder.flush(std::chrono::seconds(10)).empty(), "young group isn't flushed by timeout");
+
+    std::cout << (is_ok ? "fec_test: passed" : "fec_test: failed") << '\n';
+    return is_ok ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+#include "Network.h"
+#include "Players.h"
+#include <arpa/inet.h>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <error_repairing.h>
+#include <iostream>
+#include <netinet/in.h>
+#include <optional>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * Server on its port (loopback) - MESSAGEs are sent in format of game client, ticks are run by hand:
+ *     every MESSAGE of player A is accepted by physics check of tick (times cross low byte of ms clock)
+ *     snapshot pushed to player B has state of A's last MESSAGE
+ * Input_ring of player is checked alone: id of client at end of uint64 doesn't leave input waiting forever
+ */
+
+// ===================================
+// client
+// ===================================
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t SERVER_PORT = 20123;
+
+static bool check (bool condition, const char* message) {
+    if (not condition) std::cerr << "FAILED: " << message << '\n';
+    return condition;
+}
+
+static void write_u64 (std::vector<uint8_t>& buffer, uint64_t value) {
+    for (int shift = 56; shift >= 0; shift -= 8) buffer.push_back(uint8_t(value >> shift));
+}
+
+static uint64_t read_u64 (const std::vector<uint8_t>& buffer, size_t offset) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(value); ++i) value = value << 8 | buffer[offset + i];
+    return value;
+}
+
+class Client {
+public:
+    Client () : m_socket{socket(AF_INET, SOCK_DGRAM, 0)} {
+        timeval timeout{.tv_sec=0, .tv_usec=50000};
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    ~Client () { close(m_socket); }
+    Client (const Client& client) = delete;
+
+    void login () { send({uint8_t(Package::Type::LOGIN)}); }
+    void logout () { send({uint8_t(Package::Type::BREAK_SESSION)}); }
+
+    // MESSAGE as Client/Network/Network.cpp serializes it - doubles and time in network byte order
+    void message (uint64_t id, double x, double y, uint64_t time) {
+        std::vector<uint8_t> package{uint8_t(Package::Type::MESSAGE)};
+        write_u64(package, id);
+        for (double value : {x, y, 0.0, 0.0, 0.0, 0.0}) write_u64(package, std::bit_cast<uint64_t>(value));
+        write_u64(package, time);
+        send(std::move(package));
+    }
+
+    /**
+     * @return decoded answers received until socket is quiet
+     */
+    std::vector<std::vector<uint8_t>> receive () {
+        std::vector<std::vector<uint8_t>> result;
+        std::vector<uint8_t> datagram(2048);
+        for (;;) {
+            ssize_t size = recv(m_socket, datagram.data(), datagram.size(), 0);
+            if (size < 0) return result;
+
+            std::vector<uint8_t> answer(datagram.begin(), datagram.begin() + size);
+            if (custom_utils::decode_package(answer)) result.push_back(std::move(answer));
+        }
+    }
+
+private:
+    void send (std::vector<uint8_t> package) {
+        custom_utils::encode_package(package);
+        sockaddr_in server{.sin_family=AF_INET, .sin_port=htons(SERVER_PORT), .sin_addr={.s_addr=htonl(INADDR_LOOPBACK)}, .sin_zero={}};
+        sendto(m_socket, package.data(), package.size(), 0, reinterpret_cast<const sockaddr*>(&server), sizeof(server));
+    }
+
+private:
+    int m_socket;
+};
+
+// ===================================
+// server
+// ===================================
+
+/**
+ * @brief reader thread of server.cpp for one tick - waits for expected messages first
+ */
+static void run_tick (Network& network, Players& players, size_t messages, Clock::duration wait = std::chrono::seconds(1)) {
+    Clock::time_point deadline = Clock::now() + wait;
+    for (size_t received = 0; received < messages and Clock::now() < deadline;) {
+        if (not network.has_message()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        std::optional<Network_package> package = network.pop_message();
+        if (not package.has_value() or package->package.type == Package::Type::EMPTY) continue;
+        players.process_message(package.value());
+        ++received;
+    }
+
+    players.process_players();
+    players.push_snapshot();
+    network.flush_answers();
+}
+
+/**
+ * @return x of player in last OTHER answer, std::nullopt when there is none (or player isn't in it)
+ */
+static std::optional<double> last_x (const std::vector<std::vector<uint8_t>>& answers, uint64_t player) {
+    constexpr size_t HEADER = 1 + 2 * sizeof(uint64_t);
+
+    for (auto answer = answers.rbegin(); answer != answers.rend(); ++answer) {
+        if (answer->empty() or answer->front() != uint8_t(Answer::Type::OTHER)) continue;
+
+        uint64_t count = read_u64(*answer, 1 + sizeof(uint64_t));
+        for (size_t i = 0; i < count and HEADER + (i + 1) * World_snapshot::ENTRY_SIZE <= answer->size(); ++i) {
+            size_t entry = HEADER + i * World_snapshot::ENTRY_SIZE;
+            if (read_u64(*answer, entry) == player) return std::bit_cast<double>(read_u64(*answer, entry + sizeof(uint64_t)));
+        }
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief socket of server is opened by its receive thread - login is repeated until it is answered
+ */
+static bool connect (Network& network, Players& players, Client& client) {
+    for (size_t attempt = 0; attempt < 20; ++attempt) {
+        client.login();
+        run_tick(network, players, 1, std::chrono::milliseconds(100));
+        for (const std::vector<uint8_t>& answer : client.receive()) {
+            if (not answer.empty() and answer.front() == uint8_t(Answer::Type::REGISTERED_ANSWER)) return true;
+        }
+    }
+    return false;
+}
+
+// ===================================
+
+static bool check_input_ring () {
+    Input_ring<int> ring(4);
+    bool is_ok = check(ring.push(UINT64_MAX, 1).result == Input_result::LATE, "last uint64 id is outside of window");
+    is_ok &= check(ring.size() == 0, "last uint64 id doesn't wait");
+
+    is_ok &= check(ring.push(1, 2).result == Input_result::ACCEPTED, "id after last uint64 id is accepted");
+    size_t drained = 0;
+    ring.drain([&](uint64_t, int) { ++drained; });
+    is_ok &= check(drained == 1 and ring.size() == 0, "ring is empty after drain");
+    return is_ok;
+}
+
+int main () {
+    bool is_ok = check_input_ring();
+
+    Network network;
+    Players players(network);
+    std::thread receive_thread(&Network::socket_main, &network, 0);
+
+    Client a, b;
+    is_ok &= check(connect(network, players, a), "a is logged in");
+    is_ok &= check(connect(network, players, b), "b is logged in");
+    a.receive();
+
+    // ms clock of client - low byte wraps between messages, byte swapped times would go back
+    uint64_t time = 1'700'000'000'000ull + 250;
+    for (uint64_t id = 1; id <= 7; ++id, time += 3) {
+        double x = 10.0 * double(id);
+        a.message(id, x, 2.0, time);
+        run_tick(network, players, 1);
+
+        std::optional<double> pushed = last_x(b.receive(), 0); // a is first player - id 0
+        is_ok &= check(pushed.has_value(), "snapshot of tick is pushed to b");
+        is_ok &= check(pushed == x, "state of MESSAGE is accepted by tick");
+    }
+
+    a.logout();
+    b.logout();
+    run_tick(network, players, 2);
+    network.stop_server();
+    receive_thread.join();
+
+    std::cout << (is_ok ? "players_test: passed" : "players_test: failed") << '\n';
+    return is_ok ? 0 : 1;
+}